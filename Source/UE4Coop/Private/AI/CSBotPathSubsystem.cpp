@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSBotPathSubsystem.h"
+#include "CSTrackerBot.h"
+#include "CSTypes.h"
+
+#include "NavigationSystem/Public/NavigationSystem.h"
+#include "NavigationData.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot Path Queries"), STAT_BotPathQueries, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bot Shared Path Hits"), STAT_BotSharedPathHits, STATGROUP_Coop);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bot Path Requests Pending"), STAT_BotPathRequestsPending, STATGROUP_Coop);
+
+UCSBotPathSubsystem::UCSBotPathSubsystem()
+{
+    MaxQueriesPerFrame = 4;
+    RepathDistance = 300.0f;
+    MaxPathAge = 3.0f;
+    ShareRadius = 250.0f;
+}
+
+void UCSBotPathSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    int32 NumQueries = 0;
+    int32 NumHandled = 0;
+
+    for (; NumHandled < PendingRequests.Num() && NumQueries < MaxQueriesPerFrame; ++NumHandled)
+    {
+        const FCSBotPathRequest& Request = PendingRequests[NumHandled];
+
+        ACSTrackerBot* Bot = Request.Bot.Get();
+        AActor* Target = Request.Target.Get();
+
+        if (Bot == nullptr || Target == nullptr)
+            continue;
+
+        // A query issued earlier may have produced a path this bot can follow
+        if (TryUseSharedPath(Bot, Target))
+            continue;
+
+        if (FindPathAsync(Bot, Target))
+            NumQueries++;
+    }
+
+    PendingRequests.RemoveAt(0, NumHandled, false);
+
+    SET_DWORD_STAT(STAT_BotPathRequestsPending, PendingRequests.Num());
+}
+
+TStatId UCSBotPathSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSBotPathSubsystem, STATGROUP_Tickables);
+}
+
+void UCSBotPathSubsystem::RequestPath(ACSTrackerBot* Bot, AActor* Target)
+{
+    if (Bot == nullptr || Target == nullptr)
+        return;
+
+    if (TryUseSharedPath(Bot, Target))
+        return;
+
+    if (BotsInFlight.Contains(Bot))
+        return;
+
+    // Only keep the latest target of a bot that is already waiting
+    for (FCSBotPathRequest& Request : PendingRequests)
+    {
+        if (Request.Bot == Bot)
+        {
+            Request.Target = Target;
+            return;
+        }
+    }
+
+    FCSBotPathRequest& Request = PendingRequests.AddDefaulted_GetRef();
+    Request.Bot = Bot;
+    Request.Target = Target;
+}
+
+bool UCSBotPathSubsystem::TryUseSharedPath(ACSTrackerBot* Bot, AActor* Target)
+{
+    const FCSSharedPath* SharedPath = SharedPaths.Find(Target);
+
+    if (SharedPath == nullptr || SharedPath->PathPoints.Num() < 2)
+        return false;
+
+    const float Now = GetTickableGameObjectWorld()->GetTimeSeconds();
+
+    if (Now - SharedPath->Time > MaxPathAge)
+        return false;
+
+    if (FVector::DistSquared(SharedPath->TargetLocation, Target->GetActorLocation()) > FMath::Square(RepathDistance))
+        return false;
+
+    // Join the path at the closest point and head for the one after it
+    const FVector BotLocation = Bot->GetActorLocation();
+
+    int32 ClosestIndex = INDEX_NONE;
+    float ClosestDistanceSq = FMath::Square(ShareRadius);
+
+    for (int32 Index = 0; Index < SharedPath->PathPoints.Num(); ++Index)
+    {
+        const float DistanceSq = FVector::DistSquared(BotLocation, SharedPath->PathPoints[Index]);
+
+        if (DistanceSq <= ClosestDistanceSq)
+        {
+            ClosestDistanceSq = DistanceSq;
+            ClosestIndex = Index;
+        }
+    }
+
+    if (ClosestIndex == INDEX_NONE)
+        return false;
+
+    INC_DWORD_STAT(STAT_BotSharedPathHits);
+
+    const int32 NextIndex = FMath::Min(ClosestIndex + 1, SharedPath->PathPoints.Num() - 1);
+    Bot->SetNextPathPoint(SharedPath->PathPoints[NextIndex]);
+
+    return true;
+}
+
+bool UCSBotPathSubsystem::FindPathAsync(ACSTrackerBot* Bot, AActor* Target)
+{
+    UWorld* World = GetTickableGameObjectWorld();
+    UNavigationSystemV1* NavSys = World ? FNavigationSystem::GetCurrent<UNavigationSystemV1>(World) : nullptr;
+    ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+    if (NavData == nullptr)
+    {
+        Bot->SetNextPathPoint(Bot->GetActorLocation());
+        return false;
+    }
+
+    FPathFindingQuery Query(Bot, *NavData, Bot->GetActorLocation(), Target->GetActorLocation());
+
+    FNavPathQueryDelegate Delegate = FNavPathQueryDelegate::CreateUObject(this, &UCSBotPathSubsystem::OnPathFound,
+        TWeakObjectPtr<ACSTrackerBot>(Bot), TWeakObjectPtr<AActor>(Target));
+
+    NavSys->FindPathAsync(FNavAgentProperties::DefaultProperties, Query, Delegate, EPathFindingMode::Regular);
+
+    BotsInFlight.Add(Bot);
+
+    INC_DWORD_STAT(STAT_BotPathQueries);
+
+    return true;
+}
+
+void UCSBotPathSubsystem::OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path, TWeakObjectPtr<ACSTrackerBot> Bot, TWeakObjectPtr<AActor> Target)
+{
+    BotsInFlight.Remove(Bot);
+
+    ACSTrackerBot* MyBot = Bot.Get();
+
+    if (MyBot == nullptr)
+        return;
+
+    if (Result != ENavigationQueryResult::Success || !Path.IsValid() || Path->GetPathPoints().Num() < 2)
+    {
+        MyBot->SetNextPathPoint(MyBot->GetActorLocation());
+        return;
+    }
+
+    const TArray<FNavPathPoint>& NavPoints = Path->GetPathPoints();
+
+    if (Target.IsValid())
+    {
+        FCSSharedPath& SharedPath = SharedPaths.FindOrAdd(Target);
+        SharedPath.PathPoints.Reset(NavPoints.Num());
+
+        for (const FNavPathPoint& NavPoint : NavPoints)
+            SharedPath.PathPoints.Add(NavPoint.Location);
+
+        SharedPath.TargetLocation = Target->GetActorLocation();
+        SharedPath.Time = GetTickableGameObjectWorld()->GetTimeSeconds();
+    }
+
+    MyBot->SetNextPathPoint(NavPoints[1].Location);
+}
+
+void UCSBotPathSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    PendingRequests.Reset();
+    BotsInFlight.Reset();
+    SharedPaths.Reset();
+}
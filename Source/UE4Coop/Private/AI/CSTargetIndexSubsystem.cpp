@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSTargetIndexSubsystem.h"
+#include "CSCharacter.h"
+#include "CSTypes.h"
+
+DECLARE_CYCLE_STAT(TEXT("Target Index Update"), STAT_TargetIndexUpdate, STATGROUP_Coop);
+DECLARE_CYCLE_STAT(TEXT("Target Index Query"), STAT_TargetIndexQuery, STATGROUP_Coop);
+
+UCSTargetIndexSubsystem::UCSTargetIndexSubsystem()
+{
+    CellSize = 2000.0f;
+
+    MinCell = FIntPoint::ZeroValue;
+    MaxCell = FIntPoint::ZeroValue;
+}
+
+void UCSTargetIndexSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    if (TargetCells.Num() == 0)
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_TargetIndexUpdate);
+
+    // Move targets that crossed a cell border and recompute the occupied bounds
+    MinCell = FIntPoint(MAX_int32, MAX_int32);
+    MaxCell = FIntPoint(MIN_int32, MIN_int32);
+
+    for (TPair<ACSCharacter*, FIntPoint>& Pair : TargetCells)
+    {
+        const FIntPoint NewCell = GetCell(Pair.Key->GetActorLocation());
+
+        if (NewCell != Pair.Value)
+        {
+            RemoveFromCell(Pair.Key, Pair.Value);
+            AddToCell(Pair.Key, NewCell);
+
+            Pair.Value = NewCell;
+        }
+
+        MinCell = FIntPoint(FMath::Min(MinCell.X, NewCell.X), FMath::Min(MinCell.Y, NewCell.Y));
+        MaxCell = FIntPoint(FMath::Max(MaxCell.X, NewCell.X), FMath::Max(MaxCell.Y, NewCell.Y));
+    }
+}
+
+TStatId UCSTargetIndexSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSTargetIndexSubsystem, STATGROUP_Tickables);
+}
+
+void UCSTargetIndexSubsystem::RegisterTarget(ACSCharacter* Target)
+{
+    if (Target == nullptr || TargetCells.Contains(Target))
+        return;
+
+    const FIntPoint Cell = GetCell(Target->GetActorLocation());
+
+    if (TargetCells.Num() == 0)
+    {
+        MinCell = Cell;
+        MaxCell = Cell;
+    }
+    else
+    {
+        MinCell = FIntPoint(FMath::Min(MinCell.X, Cell.X), FMath::Min(MinCell.Y, Cell.Y));
+        MaxCell = FIntPoint(FMath::Max(MaxCell.X, Cell.X), FMath::Max(MaxCell.Y, Cell.Y));
+    }
+
+    TargetCells.Add(Target, Cell);
+    AddToCell(Target, Cell);
+}
+
+void UCSTargetIndexSubsystem::UnregisterTarget(ACSCharacter* Target)
+{
+    FIntPoint Cell;
+
+    if (TargetCells.RemoveAndCopyValue(Target, Cell))
+        RemoveFromCell(Target, Cell);
+}
+
+ACSCharacter* UCSTargetIndexSubsystem::FindNearestTarget(const FVector& Location) const
+{
+    if (TargetCells.Num() == 0)
+        return nullptr;
+
+    SCOPE_CYCLE_COUNTER(STAT_TargetIndexQuery);
+
+    const FIntPoint Origin = GetCell(Location);
+
+    // Rings past this one are entirely outside the occupied cells
+    const int32 MaxRing = FMath::Max(
+        FMath::Max(FMath::Abs(MinCell.X - Origin.X), FMath::Abs(MaxCell.X - Origin.X)),
+        FMath::Max(FMath::Abs(MinCell.Y - Origin.Y), FMath::Abs(MaxCell.Y - Origin.Y)));
+
+    ACSCharacter* NearestTarget = nullptr;
+    float NearestDistanceSq = FLT_MAX;
+
+    for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+    {
+        // Search the border of the square of cells at this distance from the origin
+        for (int32 X = Origin.X - Ring; X <= Origin.X + Ring; ++X)
+        {
+            const bool bEdgeColumn = X == Origin.X - Ring || X == Origin.X + Ring;
+            const int32 StepY = bEdgeColumn ? 1 : FMath::Max(Ring * 2, 1);
+
+            for (int32 Y = Origin.Y - Ring; Y <= Origin.Y + Ring; Y += StepY)
+            {
+                const TArray<ACSCharacter*, TInlineAllocator<4>>* CellTargets = Cells.Find(FIntPoint(X, Y));
+
+                if (CellTargets == nullptr)
+                    continue;
+
+                for (ACSCharacter* Target : *CellTargets)
+                {
+                    const float DistanceSq = FVector::DistSquared(Location, Target->GetActorLocation());
+
+                    if (DistanceSq < NearestDistanceSq)
+                    {
+                        NearestDistanceSq = DistanceSq;
+                        NearestTarget = Target;
+                    }
+                }
+            }
+        }
+
+        // Anything in the next rings is at least this far away
+        const float RingDistance = Ring * CellSize;
+
+        if (NearestTarget && NearestDistanceSq <= RingDistance * RingDistance)
+            break;
+    }
+
+    return NearestTarget;
+}
+
+int32 UCSTargetIndexSubsystem::GetNumTargets() const
+{
+    return TargetCells.Num();
+}
+
+void UCSTargetIndexSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    Cells.Reset();
+    TargetCells.Reset();
+}
+
+FIntPoint UCSTargetIndexSubsystem::GetCell(const FVector& Location) const
+{
+    return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UCSTargetIndexSubsystem::AddToCell(ACSCharacter* Target, const FIntPoint& Cell)
+{
+    Cells.FindOrAdd(Cell).Add(Target);
+}
+
+void UCSTargetIndexSubsystem::RemoveFromCell(ACSCharacter* Target, const FIntPoint& Cell)
+{
+    TArray<ACSCharacter*, TInlineAllocator<4>>* CellTargets = Cells.Find(Cell);
+
+    if (CellTargets == nullptr)
+        return;
+
+    CellTargets->RemoveSingleSwap(Target, false);
+
+    if (CellTargets->Num() == 0)
+        Cells.Remove(Cell);
+}
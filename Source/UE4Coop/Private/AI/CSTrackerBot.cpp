@@ -4,17 +4,33 @@
 #include "CSTrackerBot.h"
 #include "CSCharacter.h"
 #include "CSHealthComponent.h"
+#include "CSHitboxHistoryComponent.h"
+#include "CSEffectPoolSubsystem.h"
+#include "CSTargetIndexSubsystem.h"
+#include "CSBotPathSubsystem.h"
+#include "CSTrackerBotManager.h"
+#include "CSActorPoolSubsystem.h"
+#include "CSTypes.h"
 
 
 #include "Components/StaticMeshComponent.h"
 #include "Components/SphereComponent.h"
-#include "NavigationSystem/Public/NavigationSystem.h"
-#include "NavigationSystem/Public/NavigationPath.h"
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Sound/SoundCue.h"
 #include "Kismet/GameplayStatics.h"
 #include "DrawDebugHelpers.h"
 #include "TimerManager.h"
+#include "Net/UnrealNetwork.h"
+
+static int32 DebugTrackerBotDrawing = 0;
+FAutoConsoleVariableRef CVARDebugTrackerBotDrawing (
+    TEXT("COOP.DebugTrackerBots"), 
+    DebugTrackerBotDrawing, 
+    TEXT("Draw Debug Path Points and Forces for Tracker Bots"), 
+    ECVF_Cheat);
+
+DECLARE_CYCLE_STAT(TEXT("Tracker Bot Tick"), STAT_TrackerBotTick, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tracker Bot Ticks"), STAT_TrackerBotTicks, STATGROUP_Coop);
 
 // Sets default values
 ACSTrackerBot::ACSTrackerBot()
@@ -30,6 +46,8 @@ ACSTrackerBot::ACSTrackerBot()
     HealthComp = CreateDefaultSubobject<UCSHealthComponent>(TEXT("HealthComp"));
     HealthComp->OnHealthChanged.AddDynamic(this, &ACSTrackerBot::OnDamageTaken);
 
+    HitboxHistoryComp = CreateDefaultSubobject<UCSHitboxHistoryComponent>(TEXT("HitboxHistoryComp"));
+
     SphereComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
     SphereComp->SetSphereRadius(200.0f);
     SphereComp->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
@@ -38,6 +56,8 @@ ACSTrackerBot::ACSTrackerBot()
     SphereComp->SetupAttachment(RootComponent);
 
     bExploded = false;
+    bStartedSelfDestruction = false;
+    bPooled = false;
     bUseVelocityChange = false;
 
     MovementForce = 1000.0f;
@@ -48,6 +68,13 @@ ACSTrackerBot::ACSTrackerBot()
 
     ExplosionDamage = 60.0f;
     ExplosionRadius = 350.0f;
+
+    NearTickInterval = 1.0f / 30.0f;
+    FarTickInterval = 0.25f;
+    SignificanceNearDistance = 1500.0f;
+    SignificanceFarDistance = 6000.0f;
+
+    ManagerSlot = INDEX_NONE;
 }
 
 // Called when the game starts or when spawned
@@ -55,8 +82,48 @@ void ACSTrackerBot::BeginPlay()
 {
 	Super::BeginPlay();
 	
-    if (Role == ENetRole::ROLE_Authority)
-        NextPathPoint = GetNextPathPoint();
+    NextPathPoint = GetActorLocation();
+
+    if (Role < ENetRole::ROLE_Authority)
+        return;
+
+    if (UCSTrackerBotManager::IsBatchingEnabled())
+        RegisterWithManager();
+
+    RequestNextPathPoint();
+}
+
+void ACSTrackerBot::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UnregisterFromManager();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void ACSTrackerBot::RegisterWithManager()
+{
+    UCSTrackerBotManager* Manager = UCSWorldSubsystem::Get<UCSTrackerBotManager>(this);
+
+    if (Manager == nullptr)
+        return;
+
+    ManagerSlot = Manager->RegisterBot(this);
+
+    // The manager steers the bot from now on
+    SetActorTickEnabled(false);
+}
+
+void ACSTrackerBot::UnregisterFromManager()
+{
+    if (ManagerSlot == INDEX_NONE)
+        return;
+
+    UCSTrackerBotManager* Manager = UCSWorldSubsystem::Get<UCSTrackerBotManager>(this);
+
+    if (Manager)
+        Manager->UnregisterBot(this);
+
+    ManagerSlot = INDEX_NONE;
 }
 
 // Called every frame
@@ -67,77 +134,117 @@ void ACSTrackerBot::Tick(float DeltaTime)
     if (Role < ENetRole::ROLE_Authority || bExploded)
         return;
 
-    float DistanceToTarget = (GetActorLocation() - NextPathPoint).Size();
+    SCOPE_CYCLE_COUNTER(STAT_TrackerBotTick);
+    INC_DWORD_STAT(STAT_TrackerBotTicks);
+
+    const FVector Location = GetActorLocation();
+
+    UCSTargetIndexSubsystem* TargetIndex = UCSWorldSubsystem::Get<UCSTargetIndexSubsystem>(this);
+    AActor* NearestPlayer = TargetIndex ? TargetIndex->FindNearestTarget(Location) : nullptr;
+
+    UpdateTickInterval(NearestPlayer ? FVector::Dist(Location, NearestPlayer->GetActorLocation()) : FLT_MAX);
+
+    float DistanceToTarget = (Location - NextPathPoint).Size();
 
     if (DistanceToTarget <= RequiredDistanceToTarget) {
-        NextPathPoint = GetNextPathPoint();
+        RequestNextPathPoint();
 
-        DrawDebugString(GetWorld(), GetActorLocation(), "Target Reached");
+        if (DebugTrackerBotDrawing)
+            DrawDebugString(GetWorld(), Location, "Target Reached");
     }
     else
     {
-        FVector ForceDirection = NextPathPoint - GetActorLocation();
+        FVector ForceDirection = NextPathPoint - Location;
         ForceDirection.Normalize();
         ForceDirection *= MovementForce;
 
-        MeshComp->AddForce(ForceDirection, NAME_None, bUseVelocityChange);
+        // A force only lasts for the next physics step, push with what would have been applied since the last tick
+        MeshComp->AddImpulse(ForceDirection * DeltaTime, NAME_None, bUseVelocityChange);
 
-        DrawDebugDirectionalArrow(GetWorld(), GetActorLocation(), GetActorLocation() + ForceDirection, 32, FColor::Green, false, 0.0f, 1.0f);
+        if (DebugTrackerBotDrawing)
+            DrawDebugDirectionalArrow(GetWorld(), Location, Location + ForceDirection, 32, FColor::Green, false, 0.0f, 1.0f);
     }
 
-    DrawDebugSphere(GetWorld(), NextPathPoint, 20, 12, FColor::Yellow, false, 0.0f, 1.0f);
+    if (DebugTrackerBotDrawing)
+        DrawDebugSphere(GetWorld(), NextPathPoint, 20, 12, FColor::Yellow, false, 0.0f, 1.0f);
 }
 
-FVector ACSTrackerBot::GetNextPathPoint()
+void ACSTrackerBot::UpdateTickInterval(float DistanceToPlayer)
 {
-    AActor* NearestPlayer = nullptr;
-
-    float NearestDistance = FLT_MAX;
+    const float TickInterval = GetTickIntervalForDistance(DistanceToPlayer);
 
-    // Find nearest player connected
-    TArray<AActor*> FoundPlayers;
-    UGameplayStatics::GetAllActorsOfClass(this, ACSCharacter::StaticClass(), FoundPlayers);
+    if (!FMath::IsNearlyEqual(TickInterval, GetActorTickInterval(), 0.01f))
+        SetActorTickInterval(TickInterval);
+}
 
-    for (AActor* PlayerActor : FoundPlayers)
-    {
-        if(!IsValid(PlayerActor))
-            continue;
+float ACSTrackerBot::GetTickIntervalForDistance(float DistanceToPlayer) const
+{
+    return GetTickBands().GetInterval(DistanceToPlayer);
+}
 
-        if(!Cast<ACSCharacter>(PlayerActor)->IsPlayerControlled())
-            continue;
+FCSTrackerBotTickBands ACSTrackerBot::GetTickBands() const
+{
+    FCSTrackerBotTickBands TickBands;
+    TickBands.NearDistance = SignificanceNearDistance;
+    TickBands.FarDistance = SignificanceFarDistance;
+    TickBands.NearInterval = NearTickInterval;
+    TickBands.FarInterval = FarTickInterval;
 
-        UCSHealthComponent* HealthComponent = Cast<UCSHealthComponent>(PlayerActor->GetComponentByClass(UCSHealthComponent::StaticClass()));
-        if(HealthComponent == nullptr)
-            continue;
+    return TickBands;
+}
 
-        if(HealthComponent->IsDead())
-            continue;
+void ACSTrackerBot::RequestNextPathPoint()
+{
+    // Find nearest player connected
+    UCSTargetIndexSubsystem* TargetIndex = UCSWorldSubsystem::Get<UCSTargetIndexSubsystem>(this);
 
-        const float TempDistance = FVector::DistSquared(GetActorLocation(), PlayerActor->GetActorLocation());
-        if (NearestDistance > TempDistance)
-        {
-            NearestDistance = TempDistance;
-            NearestPlayer = PlayerActor;
-        }
-    }
+    AActor* NearestPlayer = TargetIndex ? TargetIndex->FindNearestTarget(GetActorLocation()) : nullptr;
 
     if (NearestPlayer == nullptr)
-        return FVector();
+        return;
 
     GetWorldTimerManager().ClearTimer(TimerHandle_RefreshPath);
     GetWorldTimerManager().SetTimer(TimerHandle_RefreshPath, this, &ACSTrackerBot::RefreshPath, 3.0f, false);
 
-    UNavigationPath* NavPath = UNavigationSystemV1::FindPathToActorSynchronously(this, GetActorLocation(), NearestPlayer);
+    UCSBotPathSubsystem* BotPaths = UCSWorldSubsystem::Get<UCSBotPathSubsystem>(this);
+
+    if (BotPaths)
+        BotPaths->RequestPath(this, NearestPlayer);
+}
+
+void ACSTrackerBot::SetNextPathPoint(const FVector& PathPoint)
+{
+    NextPathPoint = PathPoint;
+
+    if (ManagerSlot == INDEX_NONE)
+        return;
+
+    UCSTrackerBotManager* Manager = UCSWorldSubsystem::Get<UCSTrackerBotManager>(this);
 
-    if (NavPath && NavPath->PathPoints.Num() > 1)
-        return NavPath->PathPoints[1];
+    if (Manager)
+        Manager->SetNextPathPoint(ManagerSlot, PathPoint);
+}
+
+bool ACSTrackerBot::IsDebugDrawingEnabled()
+{
+    return DebugTrackerBotDrawing != 0;
+}
 
-    return GetActorLocation();
+UCSHealthComponent* ACSTrackerBot::GetHealthComponent() const
+{
+    return HealthComp;
 }
 
 void ACSTrackerBot::OnDamageTaken(UCSHealthComponent* OwningHealthComp, float Health, float Damage, const class UDamageType* DamageType,
                                   class AController* InstigatedBy, AActor* DamageCauser)
 {
+    // [client] health was reset by the pool, the bot is back in play
+    if (bExploded && Health > 0)
+    {
+        RestoreFromExplosion();
+        return;
+    }
+
     if(PulsingMaterialInstance == nullptr)
         PulsingMaterialInstance = MeshComp->CreateAndSetMaterialInstanceDynamicFromMaterial(0, MeshComp->GetMaterial(0));
 
@@ -155,8 +262,10 @@ void ACSTrackerBot::SelfDestruct()
 
     bExploded = true;
 
+    UnregisterFromManager();
+
     UGameplayStatics::PlaySoundAtLocation(this, ExplosionSound, GetActorLocation());
-    UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionEffect, GetActorLocation());
+    UCSEffectPoolSubsystem::PlayEffectAtLocation(this, ExplosionEffect, GetActorLocation());
 
     MeshComp->SetVisibility(false, true);
     MeshComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -172,7 +281,68 @@ void ACSTrackerBot::SelfDestruct()
     UGameplayStatics::ApplyRadialDamage(this, ExplosionDamage, GetActorLocation(), ExplosionRadius, 
                                         nullptr, IgnoredActors, this, GetInstigatorController(), true);
 
-    SetLifeSpan(1.0f);
+    // Give clients time to play the explosion before the bot is hidden
+    GetWorldTimerManager().SetTimer(TimerHandle_ReleaseToPool, this, &ACSTrackerBot::ReleaseToPool, 1.0f, false);
+}
+
+void ACSTrackerBot::RestoreFromExplosion()
+{
+    bExploded = false;
+    bStartedSelfDestruction = false;
+
+    // Collision and physics set up on the Blueprint live on the default object mesh
+    const ACSTrackerBot* DefaultBot = GetClass()->GetDefaultObject<ACSTrackerBot>();
+    const UStaticMeshComponent* DefaultMesh = DefaultBot ? DefaultBot->MeshComp : nullptr;
+
+    MeshComp->SetVisibility(true, true);
+
+    if (DefaultMesh)
+    {
+        MeshComp->SetCollisionEnabled(DefaultMesh->GetCollisionEnabled());
+        MeshComp->SetCollisionResponseToChannels(DefaultMesh->GetCollisionResponseToChannels());
+        MeshComp->SetSimulatePhysics(DefaultMesh->BodyInstance.bSimulatePhysics);
+    }
+}
+
+void ACSTrackerBot::ReleaseToPool()
+{
+    UCSActorPoolSubsystem::Release(this);
+}
+
+void ACSTrackerBot::SetPooled(bool bNewPooled)
+{
+    bPooled = bNewPooled;
+    OnRep_Pooled();
+}
+
+void ACSTrackerBot::OnRep_Pooled()
+{
+    SetActorEnableCollision(!bPooled);
+}
+
+void ACSTrackerBot::OnAcquiredFromPool_Implementation()
+{
+    RestoreFromExplosion();
+
+    HitboxHistoryComp->ClearHistory();
+    HealthComp->ResetHealth();
+
+    NextPathPoint = GetActorLocation();
+
+    if (UCSTrackerBotManager::IsBatchingEnabled())
+        RegisterWithManager();
+
+    RequestNextPathPoint();
+}
+
+void ACSTrackerBot::OnReleasedToPool_Implementation()
+{
+    UnregisterFromManager();
+
+    // Pooled bots must not keep the round going
+    HealthComp->UpdateLiveCounter(true);
+
+    MeshComp->SetSimulatePhysics(false);
 }
 
 void ACSTrackerBot::NotifyActorBeginOverlap(AActor* OtherActor)
@@ -182,7 +352,7 @@ void ACSTrackerBot::NotifyActorBeginOverlap(AActor* OtherActor)
 
     Super::NotifyActorBeginOverlap(OtherActor);
 
-    if (UCSHealthComponent::IsFriendly(this, OtherActor))
+    if (!UCSHealthComponent::IsHostile(this, OtherActor))
         return;
 
     ACSCharacter* PlayerPawn = Cast<ACSCharacter>(OtherActor);
@@ -208,5 +378,12 @@ void ACSTrackerBot::ApplySelfDamage()
 
 void ACSTrackerBot::RefreshPath()
 {
-    NextPathPoint = GetNextPathPoint();
+    RequestNextPathPoint();
+}
+
+void ACSTrackerBot::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME(ACSTrackerBot, bPooled);
 }
@@ -0,0 +1,220 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSTrackerBotManager.h"
+#include "CSCharacter.h"
+#include "CSTargetIndexSubsystem.h"
+#include "CSTypes.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/StaticMeshComponent.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tracker Bot Manager"), STAT_TrackerBotManager, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tracker Bot Managed Updates"), STAT_TrackerBotManagerTicks, STATGROUP_Coop);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Tracker Bots Managed"), STAT_TrackerBotsManaged, STATGROUP_Coop);
+
+static int32 BatchTrackerBots = 1;
+FAutoConsoleVariableRef CVARBatchTrackerBots(
+    TEXT("COOP.BatchTrackerBots"),
+    BatchTrackerBots,
+    TEXT("Steer tracker bots from a single manager instead of their own tick, read when a bot spawns"),
+    ECVF_Default);
+
+static int32 TrackerBotParallelThreshold = 64;
+FAutoConsoleVariableRef CVARTrackerBotParallelThreshold(
+    TEXT("COOP.TrackerBotParallelThreshold"),
+    TrackerBotParallelThreshold,
+    TEXT("Minimum number of managed tracker bots before steering runs in parallel"),
+    ECVF_Default);
+
+namespace EBotUpdate
+{
+    enum Type : uint8
+    {
+        /** Not due this frame */
+        Skipped,
+        /** Apply Forces */
+        Steer,
+        /** Path point reached, ask for the next one */
+        Reached,
+    };
+}
+
+void UCSTrackerBotManager::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    SET_DWORD_STAT(STAT_TrackerBotsManaged, Bots.Num());
+
+    if (Bots.Num() == 0)
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_TrackerBotManager);
+
+    const UCSTargetIndexSubsystem* TargetIndex = UCSWorldSubsystem::Get<UCSTargetIndexSubsystem>(Bots[0]);
+
+    // Actor transforms are read here once, the parallel pass only touches the arrays
+    for (int32 Slot = 0; Slot < Bots.Num(); ++Slot)
+    {
+        const FVector Position = Bots[Slot]->GetActorLocation();
+
+        Positions[Slot] = Position;
+        TimeSinceUpdate[Slot] += DeltaTime;
+
+        if (TimeSinceUpdate[Slot] < UpdateIntervals[Slot])
+            continue;
+
+        const ACSCharacter* NearestPlayer = TargetIndex ? TargetIndex->FindNearestTarget(Position) : nullptr;
+
+        TargetDistances[Slot] = NearestPlayer ? FVector::Dist(Position, NearestPlayer->GetActorLocation()) : FLT_MAX;
+    }
+
+    const bool bSingleThreaded = Bots.Num() < TrackerBotParallelThreshold;
+
+    ParallelFor(Bots.Num(), [this](int32 Slot)
+    {
+        UpdateSteering(Slot);
+    }, bSingleThreaded);
+
+    // Physics and path requests have to go through the game thread
+    for (int32 Slot = 0; Slot < Bots.Num(); ++Slot)
+    {
+        if (UpdateResults[Slot] == EBotUpdate::Skipped)
+            continue;
+
+        INC_DWORD_STAT(STAT_TrackerBotManagerTicks);
+
+        ACSTrackerBot* Bot = Bots[Slot];
+
+        if (UpdateResults[Slot] == EBotUpdate::Steer)
+        {
+            Bot->MeshComp->AddImpulse(Forces[Slot] * TimeSinceUpdate[Slot], NAME_None, Bot->bUseVelocityChange);
+
+            if (ACSTrackerBot::IsDebugDrawingEnabled())
+                DrawDebugDirectionalArrow(GetTickableGameObjectWorld(), Positions[Slot], Positions[Slot] + Forces[Slot], 32, FColor::Green, false, 0.0f, 1.0f);
+        }
+        else
+        {
+            // May come back right away with a shared path, which writes NextPathPoints[Slot]
+            Bot->RequestNextPathPoint();
+
+            if (ACSTrackerBot::IsDebugDrawingEnabled())
+                DrawDebugString(GetTickableGameObjectWorld(), Positions[Slot], "Target Reached");
+        }
+
+        if (ACSTrackerBot::IsDebugDrawingEnabled())
+            DrawDebugSphere(GetTickableGameObjectWorld(), NextPathPoints[Slot], 20, 12, FColor::Yellow, false, 0.0f, 1.0f);
+
+        TimeSinceUpdate[Slot] = 0.0f;
+    }
+}
+
+TStatId UCSTrackerBotManager::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSTrackerBotManager, STATGROUP_Tickables);
+}
+
+bool UCSTrackerBotManager::IsBatchingEnabled()
+{
+    return BatchTrackerBots != 0;
+}
+
+void UCSTrackerBotManager::UpdateSteering(int32 Slot)
+{
+    UpdateResults[Slot] = EBotUpdate::Skipped;
+
+    if (TimeSinceUpdate[Slot] < UpdateIntervals[Slot])
+        return;
+
+    const FVector& Position = Positions[Slot];
+
+    UpdateIntervals[Slot] = TickBands[Slot].GetInterval(TargetDistances[Slot]);
+
+    FVector ToPathPoint = NextPathPoints[Slot] - Position;
+
+    if (ToPathPoint.SizeSquared() <= FMath::Square(RequiredDistances[Slot]))
+    {
+        UpdateResults[Slot] = EBotUpdate::Reached;
+        return;
+    }
+
+    Forces[Slot] = ToPathPoint.GetSafeNormal() * MovementForces[Slot];
+    UpdateResults[Slot] = EBotUpdate::Steer;
+}
+
+int32 UCSTrackerBotManager::RegisterBot(ACSTrackerBot* Bot)
+{
+    const int32 Slot = Bots.Add(Bot);
+
+    Positions.Add(Bot->GetActorLocation());
+    NextPathPoints.Add(Bot->NextPathPoint);
+    Forces.Add(FVector::ZeroVector);
+    RequiredDistances.Add(Bot->RequiredDistanceToTarget);
+    MovementForces.Add(Bot->MovementForce);
+    TickBands.Add(Bot->GetTickBands());
+    TargetDistances.Add(FLT_MAX);
+    UpdateIntervals.Add(Bot->NearTickInterval);
+    TimeSinceUpdate.Add(0.0f);
+    UpdateResults.Add(EBotUpdate::Skipped);
+
+    return Slot;
+}
+
+void UCSTrackerBotManager::UnregisterBot(ACSTrackerBot* Bot)
+{
+    const int32 Slot = Bot->ManagerSlot;
+
+    if (!Bots.IsValidIndex(Slot) || Bots[Slot] != Bot)
+        return;
+
+    Bots.RemoveAtSwap(Slot, 1, false);
+    Positions.RemoveAtSwap(Slot, 1, false);
+    NextPathPoints.RemoveAtSwap(Slot, 1, false);
+    Forces.RemoveAtSwap(Slot, 1, false);
+    RequiredDistances.RemoveAtSwap(Slot, 1, false);
+    MovementForces.RemoveAtSwap(Slot, 1, false);
+    TickBands.RemoveAtSwap(Slot, 1, false);
+    TargetDistances.RemoveAtSwap(Slot, 1, false);
+    UpdateIntervals.RemoveAtSwap(Slot, 1, false);
+    TimeSinceUpdate.RemoveAtSwap(Slot, 1, false);
+    UpdateResults.RemoveAtSwap(Slot, 1, false);
+
+    // The last bot took the freed slot
+    if (Bots.IsValidIndex(Slot))
+        Bots[Slot]->ManagerSlot = Slot;
+
+    Bot->ManagerSlot = INDEX_NONE;
+}
+
+void UCSTrackerBotManager::SetNextPathPoint(int32 Slot, const FVector& PathPoint)
+{
+    if (NextPathPoints.IsValidIndex(Slot))
+        NextPathPoints[Slot] = PathPoint;
+}
+
+int32 UCSTrackerBotManager::GetNumBots() const
+{
+    return Bots.Num();
+}
+
+void UCSTrackerBotManager::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    for (ACSTrackerBot* Bot : Bots)
+        Bot->ManagerSlot = INDEX_NONE;
+
+    Bots.Reset();
+    Positions.Reset();
+    NextPathPoints.Reset();
+    Forces.Reset();
+    RequiredDistances.Reset();
+    MovementForces.Reset();
+    TickBands.Reset();
+    TargetDistances.Reset();
+    UpdateIntervals.Reset();
+    TimeSinceUpdate.Reset();
+    UpdateResults.Reset();
+}
@@ -5,6 +5,8 @@
 #include "Components/CSHealthComponent.h"
 #include "GameplayEffectExtension.h"
 #include "AbilitySystemComponent.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
 #include "Net/UnrealNetwork.h"
 
 UCSAttributeSet::UCSAttributeSet()
@@ -16,6 +18,9 @@ UCSAttributeSet::UCSAttributeSet()
 
     MaxHealth.SetBaseValue(DefaultMaxHealth);
     MaxHealth.SetCurrentValue(DefaultMaxHealth);
+
+    Damage.SetBaseValue(0.0f);
+    Damage.SetCurrentValue(0.0f);
 }
 
 void UCSAttributeSet::PreAttributeBaseChange(const FGameplayAttribute& Attribute, float& NewValue) const
@@ -26,41 +31,69 @@ void UCSAttributeSet::PreAttributeBaseChange(const FGameplayAttribute& Attribute
 
 void UCSAttributeSet::PostGameplayEffectExecute(const struct FGameplayEffectModCallbackData &Data)
 {
-    UAbilitySystemComponent* Source = Data.EffectSpec.GetContext().GetOriginalInstigatorAbilitySystemComponent();
+    if (DamageAttribute() != Data.EvaluatedData.Attribute)
+        return;
+
+    // Damage is only a carrier for the execution output, consume it right away
+    const float LocalDamage = Damage.GetCurrentValue();
+    Damage.SetBaseValue(0.0f);
+    Damage.SetCurrentValue(0.0f);
+
+    if (LocalDamage <= 0.0f)
+        return;
+
+    UAbilitySystemComponent* AbilitySystem = GetOwningAbilitySystemComponent();
 
-    if (HealthAttribute() == Data.EvaluatedData.Attribute)
+    const float OldHealth = Health.GetCurrentValue();
+    AbilitySystem->SetNumericAttributeBase(HealthAttribute(), OldHealth - LocalDamage);
+
+    // The instigator is the controller for damage coming from UE damage events, a pawn for effects applied by abilities
+    const FGameplayEffectContextHandle& Context = Data.EffectSpec.GetContext();
+
+    AController* InstigatedBy = Cast<AController>(Context.GetInstigator());
+    if (InstigatedBy == nullptr)
     {
-        // Get the Target Actor
-        AActor* DamagedActor = nullptr;
-        APlayerController* DamagedController = nullptr;
-
-        if (Data.Target.AbilityActorInfo.IsValid() && Data.Target.AbilityActorInfo->AvatarActor.IsValid())
-        {
-            DamagedActor = Data.Target.AbilityActorInfo->AvatarActor.Get();
-            DamagedController = Data.Target.AbilityActorInfo->PlayerController.Get();
-        }
-
-        // Get the Source Actor
-        AActor* AttackingActor = nullptr;
-        APlayerController* AttackingController = nullptr;
-
-        if (Source && Source->AbilityActorInfo.IsValid() && Source->AbilityActorInfo->AvatarActor.IsValid())
-        {
-            AttackingActor = Source->AbilityActorInfo->AvatarActor.Get();
-            AttackingController = Source->AbilityActorInfo->PlayerController.Get();
-        }
-
-        if (Health.GetCurrentValue() <= 0)
-        {
-            if (DamagedActor)
-            {
-            }
-        }
+        APawn* InstigatorPawn = Cast<APawn>(Context.GetInstigator());
+        InstigatedBy = InstigatorPawn ? InstigatorPawn->GetController() : nullptr;
     }
+
+    UCSHealthComponent* HealthComp = UCSHealthComponent::FindHealthComponent(GetOwningActor());
+    if (HealthComp)
+        HealthComp->HandleAttributeDamage(OldHealth, LocalDamage, InstigatedBy, Context.GetEffectCauser());
 }
 
 FGameplayAttribute UCSAttributeSet::HealthAttribute()
 {
     static UProperty* Property = FindFieldChecked<UProperty>(UCSAttributeSet::StaticClass(), GET_MEMBER_NAME_CHECKED(UCSAttributeSet, Health));
     return FGameplayAttribute(Property);
-}
\ No newline at end of file
+}
+
+FGameplayAttribute UCSAttributeSet::MaxHealthAttribute()
+{
+    static UProperty* Property = FindFieldChecked<UProperty>(UCSAttributeSet::StaticClass(), GET_MEMBER_NAME_CHECKED(UCSAttributeSet, MaxHealth));
+    return FGameplayAttribute(Property);
+}
+
+FGameplayAttribute UCSAttributeSet::DamageAttribute()
+{
+    static UProperty* Property = FindFieldChecked<UProperty>(UCSAttributeSet::StaticClass(), GET_MEMBER_NAME_CHECKED(UCSAttributeSet, Damage));
+    return FGameplayAttribute(Property);
+}
+
+void UCSAttributeSet::OnRep_Health()
+{
+    GAMEPLAYATTRIBUTE_REPNOTIFY(UCSAttributeSet, Health);
+}
+
+void UCSAttributeSet::OnRep_MaxHealth()
+{
+    GAMEPLAYATTRIBUTE_REPNOTIFY(UCSAttributeSet, MaxHealth);
+}
+
+void UCSAttributeSet::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+    Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+    DOREPLIFETIME_CONDITION_NOTIFY(UCSAttributeSet, Health, COND_None, REPNOTIFY_Always);
+    DOREPLIFETIME_CONDITION_NOTIFY(UCSAttributeSet, MaxHealth, COND_None, REPNOTIFY_Always);
+}
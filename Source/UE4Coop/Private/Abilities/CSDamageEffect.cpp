@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSDamageEffect.h"
+#include "CSDamageExecution.h"
+
+UCSDamageEffect::UCSDamageEffect()
+{
+    DurationPolicy = EGameplayEffectDurationType::Instant;
+
+    FGameplayEffectExecutionDefinition DamageExecution;
+    DamageExecution.CalculationClass = UCSDamageExecution::StaticClass();
+
+    Executions.Add(DamageExecution);
+}
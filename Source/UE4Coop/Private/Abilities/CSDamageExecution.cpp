@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSDamageExecution.h"
+#include "CSAttributeSet.h"
+
+void UCSDamageExecution::Execute_Implementation(const FGameplayEffectCustomExecutionParameters& ExecutionParams, FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const
+{
+    const FGameplayEffectSpec& Spec = ExecutionParams.GetOwningSpec();
+
+    const float Damage = Spec.GetSetByCallerMagnitude(GetDamageTag(), true, 0.0f);
+    if (Damage <= 0.0f)
+        return;
+
+    OutExecutionOutput.AddOutputModifier(FGameplayModifierEvaluatedData(UCSAttributeSet::DamageAttribute(), EGameplayModOp::Additive, Damage));
+}
+
+FGameplayTag UCSDamageExecution::GetDamageTag()
+{
+    static const FGameplayTag DamageTag = FGameplayTag::RequestGameplayTag(TEXT("Data.Damage"));
+    return DamageTag;
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSWorldSubsystem.h"
+
+#include "Engine/World.h"
+
+void UCSWorldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &UCSWorldSubsystem::HandleWorldCleanup);
+
+    bInitialized = true;
+}
+
+void UCSWorldSubsystem::Deinitialize()
+{
+    bInitialized = false;
+
+    FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+
+    Super::Deinitialize();
+}
+
+void UCSWorldSubsystem::Tick(float DeltaTime)
+{
+}
+
+bool UCSWorldSubsystem::IsTickable() const
+{
+    return bInitialized && !IsTemplate();
+}
+
+UWorld* UCSWorldSubsystem::GetTickableGameObjectWorld() const
+{
+    return GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+}
+
+TStatId UCSWorldSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSWorldSubsystem, STATGROUP_Tickables);
+}
+
+void UCSWorldSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+}
+
+void UCSWorldSubsystem::HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    if (World && World->GetGameInstance() == GetGameInstance())
+        OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+}
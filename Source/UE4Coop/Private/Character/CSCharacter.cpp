@@ -4,8 +4,11 @@
 #include "CSWeapon.h"
 #include "CSTypes.h"
 #include "Components/CSHealthComponent.h"
+#include "Components/CSHitboxHistoryComponent.h"
 #include "Abilities/CSAttributeSet.h"
 #include "CSPlayerState.h"
+#include "CSTargetIndexSubsystem.h"
+#include "CSActorPoolSubsystem.h"
 
 #include "Materials/MaterialInstanceDynamic.h"
 #include "Animation/AnimMontage.h"
@@ -37,8 +40,13 @@ ACSCharacter::ACSCharacter()
 
     HealthComp = CreateDefaultSubobject<UCSHealthComponent>(TEXT("HealthComp"));
 
+    HitboxHistoryComp = CreateDefaultSubobject<UCSHitboxHistoryComponent>(TEXT("HitboxHistoryComp"));
+
     // Our ability system component
     AbilitySystem = CreateDefaultSubobject<UAbilitySystemComponent>(TEXT("AbilitySystem"));
+    AbilitySystem->SetIsReplicated(true);
+    // Attributes replicate on their own, effects are only needed on the server
+    AbilitySystem->SetReplicationMode(EGameplayEffectReplicationMode::Minimal);
     AttributeSet = CreateDefaultSubobject<UCSAttributeSet>(TEXT("AttributeSet"));
 
     ZoomedFOV = 65.5f;
@@ -88,10 +96,33 @@ void ACSCharacter::BeginPlay()
     UpdateTeamColorsAllMIDs();
 }
 
+void ACSCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UCSTargetIndexSubsystem* TargetIndex = UCSWorldSubsystem::Get<UCSTargetIndexSubsystem>(this);
+    if (TargetIndex)
+        TargetIndex->UnregisterTarget(this);
+
+    // [server] the weapon outlives us in the actor pool
+    if (HasAuthority() && EndPlayReason == EEndPlayReason::Destroyed && CurrentWeapon)
+    {
+        UCSActorPoolSubsystem::Release(CurrentWeapon);
+        CurrentWeapon = nullptr;
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void ACSCharacter::PossessedBy(AController* NewController)
 {
     Super::PossessedBy(NewController);
 
+    // [server] live players are what bots go after
+    UCSTargetIndexSubsystem* TargetIndex = UCSWorldSubsystem::Get<UCSTargetIndexSubsystem>(this);
+    if (TargetIndex && NewController && NewController->IsPlayerController() && IsAlive())
+        TargetIndex->RegisterTarget(this);
+
+    HealthComp->UpdateLiveCounter();
+
     if (AbilitySystem)
         AbilitySystem->RefreshAbilityActorInfo();
 
@@ -110,6 +141,18 @@ void ACSCharacter::Tick(float DeltaTime)
     CameraComp->SetFieldOfView(NewFOV);
 }
 
+void ACSCharacter::UnPossessed()
+{
+    UCSTargetIndexSubsystem* TargetIndex = UCSWorldSubsystem::Get<UCSTargetIndexSubsystem>(this);
+    if (TargetIndex)
+        TargetIndex->UnregisterTarget(this);
+
+    Super::UnPossessed();
+
+    if (HasAuthority())
+        HealthComp->UpdateLiveCounter();
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -230,11 +273,8 @@ bool ACSCharacter::CanReload() const
 
 void ACSCharacter::SpawnDefaultWeapon()
 {
-    // Spawn a default weapon
-    FActorSpawnParameters SpawnParams;
-    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-    ACSWeapon* Weapon = GetWorld()->SpawnActor<ACSWeapon>(StarterWeaponClass, FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+    // Take a default weapon from the pool
+    ACSWeapon* Weapon = UCSActorPoolSubsystem::Acquire<ACSWeapon>(this, StarterWeaponClass, GetActorTransform(), this, this);
     EquipWeapon(Weapon);
 }
 
@@ -243,7 +283,9 @@ void ACSCharacter::EquipWeapon(ACSWeapon* NewWeapon)
     if (!HasAuthority())
         return;
 
-    // TODO: Unequip last weapon
+    // The weapon unequips itself on release
+    if (CurrentWeapon && CurrentWeapon != NewWeapon)
+        UCSActorPoolSubsystem::Release(CurrentWeapon);
 
     CurrentWeapon = NewWeapon;
 
@@ -387,6 +429,10 @@ void ACSCharacter::OnHealthChanged(UCSHealthComponent* HealthComponent, float He
     {
         bDied = true;
 
+        UCSTargetIndexSubsystem* TargetIndex = UCSWorldSubsystem::Get<UCSTargetIndexSubsystem>(this);
+        if (TargetIndex)
+            TargetIndex->UnregisterTarget(this);
+
         DetachFromControllerPendingDestroy();
 
         GetMovementComponent()->StopMovementImmediately();
@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSDamageSubsystem.h"
+#include "CSTypes.h"
+
+#include "GameFramework/Controller.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Resolve"), STAT_DamageResolve, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Hits Queued"), STAT_DamageHitsQueued, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Victims Resolved"), STAT_DamageVictimsResolved, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Feedback Sent"), STAT_DamageFeedbackSent, STATGROUP_Coop);
+
+static int32 CoalesceDamage = 1;
+FAutoConsoleVariableRef CVARCoalesceDamage(
+    TEXT("COOP.CoalesceDamage"),
+    CoalesceDamage,
+    TEXT("Resolve the hits taken by each health component once at the end of the frame instead of one by one"),
+    ECVF_Default);
+
+void UCSDamageSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    ResolveDamage();
+
+    // After resolving, so the damage of this frame goes out with it
+    FlushDamageFeedback();
+}
+
+void UCSDamageSubsystem::ResolveDamage()
+{
+    if (PendingDamage.Num() == 0)
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_DamageResolve);
+    INC_DWORD_STAT_BY(STAT_DamageHitsQueued, PendingDamage.Num());
+
+    // Deaths can cause more damage, e.g. exploding bots, that is resolved next frame
+    const TArray<FCSPendingDamage> Hits = MoveTemp(PendingDamage);
+    PendingDamage.Reset();
+    PendingHealth.Reset();
+
+    MergeHits(Hits, Victims, VictimIndices);
+
+    INC_DWORD_STAT_BY(STAT_DamageVictimsResolved, Victims.Num());
+
+    for (const FCSDamageVictim& Victim : Victims)
+    {
+        // Victims may have been destroyed by an earlier death
+        if (!IsValid(Victim.HealthComp))
+            continue;
+
+        Victim.HealthComp->ApplyDamage(Victim.Damage, Victim.DamageType, Victim.InstigatedBy.Get(), Victim.DamageCauser.Get(), Victim.Contributions);
+    }
+
+    Victims.Reset();
+    VictimIndices.Reset();
+}
+
+TStatId UCSDamageSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSDamageSubsystem, STATGROUP_Tickables);
+}
+
+bool UCSDamageSubsystem::IsDamageCoalescingEnabled()
+{
+    return CoalesceDamage != 0;
+}
+
+void UCSDamageSubsystem::QueueDamage(UCSHealthComponent* Victim, float Damage, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser)
+{
+    FCSPendingDamage& Hit = PendingDamage.AddDefaulted_GetRef();
+    Hit.Victim = Victim;
+    Hit.Damage = Damage;
+    Hit.DamageType = DamageType;
+    Hit.InstigatedBy = InstigatedBy;
+    Hit.DamageCauser = DamageCauser;
+
+    float* Health = PendingHealth.Find(Victim);
+    if (Health == nullptr)
+        Health = &PendingHealth.Add(Victim, Victim->GetHealth());
+
+    *Health = Victim->GetHealthAfterDamage(*Health, Damage);
+}
+
+bool UCSDamageSubsystem::IsDoomed(const UCSHealthComponent* HealthComp) const
+{
+    const float* Health = PendingHealth.Find(HealthComp);
+
+    return Health && *Health <= 0.0f;
+}
+
+void UCSDamageSubsystem::QueueDamageFeedback(UCSHealthComponent* HealthComp)
+{
+    FeedbackComponents.AddUnique(HealthComp);
+}
+
+void UCSDamageSubsystem::FlushDamageFeedback()
+{
+    // Components waiting for their next net update stay queued
+    FeedbackComponents.RemoveAllSwap([](const TWeakObjectPtr<UCSHealthComponent>& HealthComp)
+    {
+        if (!HealthComp.IsValid())
+            return true;
+
+        const bool bSent = HealthComp->FlushDamageFeedback();
+
+        if (bSent)
+            INC_DWORD_STAT(STAT_DamageFeedbackSent);
+
+        return bSent;
+    });
+}
+
+void UCSDamageSubsystem::MergeHits(const TArray<FCSPendingDamage>& Hits, TArray<FCSDamageVictim>& OutVictims, TMap<UCSHealthComponent*, int32>& OutVictimIndices)
+{
+    OutVictims.Reset();
+    OutVictimIndices.Reset();
+
+    for (int32 HitIndex = 0; HitIndex < Hits.Num(); HitIndex++)
+    {
+        const FCSPendingDamage& Hit = Hits[HitIndex];
+
+        UCSHealthComponent* HealthComp = Hit.Victim.Get();
+        if (HealthComp == nullptr)
+            continue;
+
+        int32* VictimIndex = OutVictimIndices.Find(HealthComp);
+
+        if (VictimIndex == nullptr)
+        {
+            if (HealthComp->IsDead())
+                continue;
+
+            VictimIndex = &OutVictimIndices.Add(HealthComp, OutVictims.AddDefaulted());
+
+            FCSDamageVictim& NewVictim = OutVictims[*VictimIndex];
+            NewVictim.HealthComp = HealthComp;
+            NewVictim.Health = HealthComp->GetHealth();
+            NewVictim.Damage = 0.0f;
+            NewVictim.DamageType = nullptr;
+            NewVictim.HitIndex = HitIndex;
+        }
+
+        FCSDamageVictim& Victim = OutVictims[*VictimIndex];
+
+        // Hits after the killing one are ignored, as they would have been on a dead victim
+        if (Victim.Health <= 0.0f)
+            continue;
+
+        const float NewHealth = HealthComp->GetHealthAfterDamage(Victim.Health, Hit.Damage);
+
+        AActor* DamageCauser = Hit.DamageCauser.Get();
+
+        FCSDamageContribution* Contribution = Victim.Contributions.FindByPredicate([DamageCauser](const FCSDamageContribution& Other)
+        {
+            return Other.DamageCauser.Get() == DamageCauser;
+        });
+
+        if (Contribution == nullptr)
+        {
+            Contribution = &Victim.Contributions.AddDefaulted_GetRef();
+            Contribution->DamageCauser = DamageCauser;
+            Contribution->Damage = 0.0f;
+        }
+
+        Contribution->Damage += Victim.Health - NewHealth;
+
+        Victim.Health = NewHealth;
+        Victim.Damage += Hit.Damage;
+        Victim.DamageType = Hit.DamageType;
+        Victim.InstigatedBy = Hit.InstigatedBy;
+        Victim.DamageCauser = Hit.DamageCauser;
+
+        if (NewHealth <= 0.0f)
+            Victim.HitIndex = HitIndex;
+    }
+
+    OutVictims.StableSort([](const FCSDamageVictim& A, const FCSDamageVictim& B)
+    {
+        return A.HitIndex < B.HitIndex;
+    });
+}
+
+void UCSDamageSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    PendingDamage.Reset();
+    PendingHealth.Reset();
+    Victims.Reset();
+    VictimIndices.Reset();
+    FeedbackComponents.Reset();
+}
@@ -2,13 +2,26 @@
 
 
 #include "CSHealthComponent.h"
+#include "CSHealthOwner.h"
 #include "CSGameMode.h"
 #include "CSCharacter.h"
+#include "CSAttributeSet.h"
+#include "CSDamageEffect.h"
+#include "CSDamageExecution.h"
+#include "CSDamageSubsystem.h"
+
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
 
 #include "GameFramework/DamageType.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
 #include "Net/UnrealNetwork.h"
 
+/** Damage reports kept for one net update, further damage is added to the last one */
+static const int32 MaxDamageFeedback = 16;
+
 // Sets default values for this component's properties
 UCSHealthComponent::UCSHealthComponent()
 {
@@ -21,6 +34,13 @@ UCSHealthComponent::UCSHealthComponent()
 
     TeamNum = 255;
 
+    LiveCounter = ECSLiveCounter::None;
+
+    AbilitySystem = nullptr;
+    PendingDamageType = nullptr;
+
+    NextDamageFeedbackTime = 0.0f;
+
     SetIsReplicated(true);
 }
 
@@ -29,14 +49,74 @@ void UCSHealthComponent::BeginPlay()
 {
     Super::BeginPlay();
 
+    AActor* MyOwner = GetOwner();
+
     if (GetOwnerRole() == ROLE_Authority)
     {
-        AActor* MyOwner = GetOwner();
         if (MyOwner)
             MyOwner->OnTakeAnyDamage.AddDynamic(this, &UCSHealthComponent::OnDamageTaken);
     }
 
     Health = MaxHealth;
+
+    UAbilitySystemComponent* OwnerAbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(MyOwner);
+    if (OwnerAbilitySystem && OwnerAbilitySystem->GetSet<UCSAttributeSet>())
+    {
+        AbilitySystem = OwnerAbilitySystem;
+
+        if (GetOwnerRole() == ROLE_Authority)
+        {
+            AbilitySystem->SetNumericAttributeBase(UCSAttributeSet::MaxHealthAttribute(), MaxHealth);
+            AbilitySystem->SetNumericAttributeBase(UCSAttributeSet::HealthAttribute(), MaxHealth);
+        }
+        else
+            AbilitySystem->GetGameplayAttributeValueChangeDelegate(UCSAttributeSet::HealthAttribute()).AddUObject(this, &UCSHealthComponent::OnHealthAttributeChanged);
+    }
+
+    if (GetOwnerRole() == ROLE_Authority)
+        UpdateLiveCounter();
+}
+
+void UCSHealthComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (GetOwnerRole() == ROLE_Authority)
+        UpdateLiveCounter(true);
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void UCSHealthComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+    Super::PreReplication(ChangedPropertyTracker);
+
+    // The attribute set replicates the health of ability system owners
+    DOREPLIFETIME_ACTIVE_OVERRIDE(UCSHealthComponent, Health, AbilitySystem == nullptr);
+}
+
+ECSLiveCounter UCSHealthComponent::GetOwnerLiveCounter() const
+{
+    const APawn* PawnOwner = Cast<APawn>(GetOwner());
+
+    return GetLiveCounter(PawnOwner != nullptr, PawnOwner && PawnOwner->IsPlayerControlled(), IsDead());
+}
+
+ECSLiveCounter UCSHealthComponent::GetLiveCounter(bool bIsPawn, bool bIsPlayerControlled, bool bIsDead)
+{
+    if (!bIsPawn || bIsDead)
+        return ECSLiveCounter::None;
+
+    return bIsPlayerControlled ? ECSLiveCounter::Player : ECSLiveCounter::Bot;
+}
+
+void UCSHealthComponent::UpdateLiveCounter(bool bRemoved)
+{
+    ACSGameMode* CSGameMode = GetWorld() ? Cast<ACSGameMode>(GetWorld()->GetAuthGameMode()) : nullptr;
+    if (!CSGameMode)
+        return;
+
+    const ECSLiveCounter NewLiveCounter = bRemoved ? ECSLiveCounter::None : GetOwnerLiveCounter();
+
+    CSGameMode->UpdateLiveCounter(LiveCounter, NewLiveCounter);
 }
 
 void UCSHealthComponent::OnDamageTaken(AActor* DamagedActor, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser)
@@ -48,71 +128,278 @@ void UCSHealthComponent::OnDamageTaken(AActor* DamagedActor, float Damage, const
     if (!CSGameMode)
         return;
 
-    if (DamagedActor != DamageCauser && (IsFriendly(DamagedActor, DamageCauser) && !CSGameMode->IsFriendlyFireAllowed()))
+    if (DamagedActor != DamageCauser && !CSGameMode->IsFriendlyFireAllowed() && IsFriendly(DamagedActor, DamageCauser))
         return;
 
+    // Massed fire on one target is resolved once per frame
+    UCSDamageSubsystem* DamageSubsystem = UCSDamageSubsystem::IsDamageCoalescingEnabled() ? UCSWorldSubsystem::Get<UCSDamageSubsystem>(this) : nullptr;
+
+    if (DamageSubsystem)
+        DamageSubsystem->QueueDamage(this, Damage, DamageType, InstigatedBy, DamageCauser);
+    else
+        ApplyDamage(Damage, DamageType, InstigatedBy, DamageCauser);
+}
+
+void UCSHealthComponent::ApplyDamage(float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser,
+    TArrayView<const FCSDamageContribution> Contributions)
+{
+    if (Damage <= 0.0f || bIsDead)
+        return;
+
+    if (AbilitySystem)
+    {
+        PendingContributions = Contributions;
+        ApplyDamageEffect(Damage, DamageType, InstigatedBy, DamageCauser);
+        PendingContributions = TArrayView<const FCSDamageContribution>();
+        return;
+    }
+
     const float OldHealth = Health;
 
-    Health = FMath::Clamp(Health - Damage, -1.0f, MaxHealth);
+    Health = GetHealthAfterDamage(Health, Damage);
 
-    OnHealthChanged.Broadcast(this, Health, Damage, DamageType, InstigatedBy, DamageCauser);
+    HandleDamage(OldHealth, Damage, DamageType, InstigatedBy, DamageCauser, Contributions);
+}
+
+float UCSHealthComponent::GetHealthAfterDamage(float CurrentHealth, float Damage) const
+{
+    // The health attribute stops at 0, the component health at -1
+    const float MinHealth = AbilitySystem ? 0.0f : -1.0f;
+
+    return FMath::Clamp(CurrentHealth - Damage, MinHealth, GetMaxHealth());
+}
+
+void UCSHealthComponent::ApplyDamageEffect(float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser)
+{
+    FGameplayEffectContextHandle Context = AbilitySystem->MakeEffectContext();
+    Context.AddInstigator(InstigatedBy, DamageCauser);
 
-    bIsDead = Health <= 0.0f;
+    FGameplayEffectSpec Spec(GetDefault<UCSDamageEffect>(), Context, 1.0f);
+    Spec.SetSetByCallerMagnitude(UCSDamageExecution::GetDamageTag(), Damage);
+
+    // Instant effects execute right away, the damage type is picked up again in HandleAttributeDamage
+    PendingDamageType = DamageType;
+    AbilitySystem->ApplyGameplayEffectSpecToSelf(Spec);
+    PendingDamageType = nullptr;
+}
+
+void UCSHealthComponent::HandleAttributeDamage(float OldHealth, float Damage, class AController* InstigatedBy, AActor* DamageCauser)
+{
+    if (bIsDead)
+        return;
+
+    HandleDamage(OldHealth, Damage, PendingDamageType, InstigatedBy, DamageCauser, PendingContributions);
+}
+
+void UCSHealthComponent::HandleDamage(float OldHealth, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser,
+    TArrayView<const FCSDamageContribution> Contributions)
+{
+    ACSGameMode* CSGameMode = Cast<ACSGameMode>(GetWorld()->GetAuthGameMode());
+
+    const float NewHealth = GetHealth();
+
+    OnHealthChanged.Broadcast(this, NewHealth, Damage, DamageType, InstigatedBy, DamageCauser);
+
+    bIsDead = NewHealth <= 0.0f;
+
+    if (bIsDead)
+        UpdateLiveCounter();
+
+    if (Contributions.Num() == 0)
+    {
+        ACSCharacter* CSDamageCauser = Cast<ACSCharacter>(DamageCauser);
+        if(CSDamageCauser)
+            CSDamageCauser->RegisterAction(ECharacterAction::DamageDone, OldHealth - NewHealth);
+    }
 
-    ACSCharacter* CSDamageCauser = Cast<ACSCharacter>(DamageCauser);
-    if(CSDamageCauser)
-        CSDamageCauser->RegisterAction(ECharacterAction::DamageDone, OldHealth - Health);
+    for (const FCSDamageContribution& Contribution : Contributions)
+    {
+        ACSCharacter* CSDamageCauser = Cast<ACSCharacter>(Contribution.DamageCauser.Get());
+        if (CSDamageCauser)
+            CSDamageCauser->RegisterAction(ECharacterAction::DamageDone, Contribution.Damage);
+    }
 
     ACSCharacter* CSOwner = Cast<ACSCharacter>(GetOwner());
     if (CSOwner)
     {
-        // If owner is player send a client OnDamageTaken event broadcast
+        // If owner is a player, report the damage to its client
         if (CSOwner->Controller && CSOwner->Controller->PlayerState)
-            ClientDamageTaken(Damage, InstigatedBy, DamageCauser);
+            AddDamageFeedback(Damage, InstigatedBy, DamageCauser);
 
         CSOwner->RegisterAction(ECharacterAction::DamageTaken, Damage);
 
-        if (bIsDead)
+        if (bIsDead && CSGameMode)
             CSGameMode->Killed(InstigatedBy, CSOwner->Controller, CSOwner, DamageType);
     }
 }
 
 void UCSHealthComponent::ApplyHeal(float HealAmount)
 {
-    if (HealAmount <= 0.0f || Health <= 0.0f)
+    if (HealAmount <= 0.0f || GetHealth() <= 0.0f)
         return;
 
-    Health = FMath::Clamp(Health + HealAmount, -1.0f, MaxHealth);
+    if (AbilitySystem)
+        AbilitySystem->ApplyModToAttribute(UCSAttributeSet::HealthAttribute(), EGameplayModOp::Additive, HealAmount);
+    else
+        Health = FMath::Clamp(Health + HealAmount, -1.0f, MaxHealth);
+
+    OnHealthChanged.Broadcast(this, GetHealth(), -HealAmount, nullptr, nullptr, nullptr);
+}
+
+void UCSHealthComponent::ResetHealth()
+{
+    const float OldHealth = GetHealth();
+
+    if (AbilitySystem)
+        AbilitySystem->SetNumericAttributeBase(UCSAttributeSet::HealthAttribute(), GetMaxHealth());
+    else
+        Health = MaxHealth;
+
+    bIsDead = false;
+
+    UpdateLiveCounter();
 
-    OnHealthChanged.Broadcast(this, Health, -HealAmount, nullptr, nullptr, nullptr);
+    OnHealthChanged.Broadcast(this, GetHealth(), OldHealth - GetHealth(), nullptr, nullptr, nullptr);
 }
 
 bool UCSHealthComponent::IsFriendly(AActor* ActorA, AActor* ActorB)
+{
+    return GetTeamAttitude(ActorA, ActorB) == ECSTeamAttitude::Allied;
+}
+
+bool UCSHealthComponent::IsHostile(AActor* ActorA, AActor* ActorB)
+{
+    return GetTeamAttitude(ActorA, ActorB) == ECSTeamAttitude::Hostile;
+}
+
+ECSTeamAttitude UCSHealthComponent::GetTeamAttitude(AActor* ActorA, AActor* ActorB)
 {
     if (ActorA == nullptr || ActorB == nullptr)
-        return true;
+        return ECSTeamAttitude::Allied;
 
-    UCSHealthComponent* HealthCompA = Cast<UCSHealthComponent>(ActorA->GetComponentByClass(UCSHealthComponent::StaticClass()));
-    UCSHealthComponent* HealthCompB = Cast<UCSHealthComponent>(ActorB->GetComponentByClass(UCSHealthComponent::StaticClass()));
+    UCSHealthComponent* HealthCompA = FindHealthComponent(ActorA);
+    UCSHealthComponent* HealthCompB = FindHealthComponent(ActorB);
 
     if (HealthCompA == nullptr || HealthCompB == nullptr)
-        return true;
+        return ECSTeamAttitude::Allied;
 
-    return HealthCompA->TeamNum == HealthCompB->TeamNum;
+    ACSGameMode* CSGameMode = Cast<ACSGameMode>(ActorA->GetWorld()->GetAuthGameMode());
+    if (CSGameMode)
+        return CSGameMode->GetTeamAttitude(HealthCompA->TeamNum, HealthCompB->TeamNum);
+
+    return HealthCompA->TeamNum == HealthCompB->TeamNum ? ECSTeamAttitude::Allied : ECSTeamAttitude::Hostile;
 }
 
-void UCSHealthComponent::ClientDamageTaken_Implementation(float Damage, class AController* InstigatedBy, AActor* DamageCauser)
+UCSHealthComponent* UCSHealthComponent::FindHealthComponent(const AActor* Actor)
+{
+    if (Actor == nullptr)
+        return nullptr;
+
+    const ICSHealthOwner* HealthOwner = Cast<ICSHealthOwner>(Actor);
+    if (HealthOwner)
+        return HealthOwner->GetHealthComponent();
+
+    return Actor->FindComponentByClass<UCSHealthComponent>();
+}
+
+void UCSHealthComponent::AddDamageFeedback(float Damage, class AController* InstigatedBy, AActor* DamageCauser)
 {
     AActor* MyOwner = GetOwner();
-    if (MyOwner)
-        MyOwner->OnTakeAnyDamage.Broadcast(MyOwner, Damage, nullptr, InstigatedBy, DamageCauser);
+    if (MyOwner == nullptr)
+        return;
+
+    FCSDamageFeedback Feedback;
+    Feedback.Amount = FMath::Clamp(FMath::RoundToInt(Damage), 0, int32(MAX_uint16));
+
+    AActor* Source = DamageCauser ? DamageCauser : (InstigatedBy ? InstigatedBy->GetPawn() : nullptr);
+    if (Source && Source != MyOwner)
+    {
+        const FVector ToSource = Source->GetActorLocation() - MyOwner->GetActorLocation();
+
+        Feedback.DirectionYaw = FRotator::CompressAxisToByte(ToSource.Rotation().Yaw);
+        Feedback.bHasDirection = true;
+    }
+
+    if (InstigatedBy && InstigatedBy->PlayerState)
+        Feedback.InstigatorId = InstigatedBy->PlayerState->PlayerId;
+
+    // Above the cap the damage still counts, only its direction is lost
+    if (PendingDamageFeedback.Num() >= MaxDamageFeedback)
+    {
+        FCSDamageFeedback& Last = PendingDamageFeedback.Last();
+        Last.Amount = FMath::Min(int32(Last.Amount) + int32(Feedback.Amount), int32(MAX_uint16));
+    }
+    else
+        PendingDamageFeedback.Add(Feedback);
+
+    UCSDamageSubsystem* DamageSubsystem = UCSWorldSubsystem::Get<UCSDamageSubsystem>(this);
+
+    if (DamageSubsystem)
+        DamageSubsystem->QueueDamageFeedback(this);
+    else
+    {
+        ClientDamageFeedback(PendingDamageFeedback);
+        PendingDamageFeedback.Reset();
+    }
 }
 
-bool UCSHealthComponent::ClientDamageTaken_Validate(float Damage, class AController* InstigatedBy, AActor* DamageCauser)
+bool UCSHealthComponent::FlushDamageFeedback()
 {
+    AActor* MyOwner = GetOwner();
+    if (MyOwner == nullptr || PendingDamageFeedback.Num() == 0)
+    {
+        PendingDamageFeedback.Reset();
+        return true;
+    }
+
+    const float Now = GetWorld()->GetTimeSeconds();
+    if (Now < NextDamageFeedbackTime)
+        return false;
+
+    NextDamageFeedbackTime = Now + 1.0f / FMath::Max(MyOwner->NetUpdateFrequency, 1.0f);
+
+    ClientDamageFeedback(PendingDamageFeedback);
+
+    PendingDamageFeedback.Reset();
+
     return true;
 }
 
+void UCSHealthComponent::ClientDamageFeedback_Implementation(const TArray<FCSDamageFeedback>& Feedback)
+{
+    AActor* MyOwner = GetOwner();
+    if (MyOwner == nullptr)
+        return;
+
+    AGameStateBase* GameState = GetWorld()->GetGameState();
+
+    for (const FCSDamageFeedback& Entry : Feedback)
+    {
+        APlayerState* InstigatorState = nullptr;
+
+        if (GameState && Entry.InstigatorId != INDEX_NONE)
+        {
+            APlayerState* const* FoundState = GameState->PlayerArray.FindByPredicate([&Entry](const APlayerState* PlayerState)
+            {
+                return PlayerState && PlayerState->PlayerId == Entry.InstigatorId;
+            });
+
+            InstigatorState = FoundState ? *FoundState : nullptr;
+        }
+
+        // Only our own controller exists here, other players' controllers are not replicated
+        AController* InstigatedBy = InstigatorState ? Cast<AController>(InstigatorState->GetOwner()) : nullptr;
+
+        const FVector DamageDirection = Entry.bHasDirection ? FRotator(0.0f, FRotator::DecompressAxisFromByte(Entry.DirectionYaw), 0.0f).Vector() : FVector::ZeroVector;
+
+        // A listen server host already got OnTakeAnyDamage from the real damage, broadcasting again would apply it twice
+        if (GetOwnerRole() < ROLE_Authority)
+            MyOwner->OnTakeAnyDamage.Broadcast(MyOwner, Entry.Amount, nullptr, InstigatedBy, nullptr);
+
+        OnDamageFeedback.Broadcast(this, Entry.Amount, DamageDirection, InstigatorState);
+    }
+}
+
 void UCSHealthComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
     Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -129,17 +416,32 @@ void UCSHealthComponent::OnRep_Health(float OldHealth)
     OnHealthChanged.Broadcast(this, Health, damage, nullptr, nullptr, nullptr);
 }
 
+void UCSHealthComponent::OnHealthAttributeChanged(const FOnAttributeChangeData& Data)
+{
+    OnHealthChanged.Broadcast(this, Data.NewValue, Data.NewValue - Data.OldValue, nullptr, nullptr, nullptr);
+}
+
 float UCSHealthComponent::GetHealth() const
 {
-    return Health;
+    return AbilitySystem ? AbilitySystem->GetNumericAttribute(UCSAttributeSet::HealthAttribute()) : Health;
 }
 
 float UCSHealthComponent::GetMaxHealth() const
 {
-    return MaxHealth;
+    return AbilitySystem ? AbilitySystem->GetNumericAttribute(UCSAttributeSet::MaxHealthAttribute()) : MaxHealth;
 }
 
 bool UCSHealthComponent::IsDead() const
 {
-    return Health <= 0;
+    return GetHealth() <= 0;
+}
+
+bool UCSHealthComponent::IsDeadOrDoomed() const
+{
+    if (IsDead())
+        return true;
+
+    const UCSDamageSubsystem* DamageSubsystem = UCSWorldSubsystem::Get<UCSDamageSubsystem>(this);
+
+    return DamageSubsystem && DamageSubsystem->IsDoomed(this);
 }
\ No newline at end of file
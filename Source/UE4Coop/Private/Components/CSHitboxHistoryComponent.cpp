@@ -0,0 +1,212 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSHitboxHistoryComponent.h"
+
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Actor.h"
+
+// Sets default values for this component's properties
+UCSHitboxHistoryComponent::UCSHitboxHistoryComponent()
+{
+    // Record after physics so the snapshot matches what gets replicated this frame
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.bStartWithTickEnabled = false;
+    PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+    MaxSnapshots = 64;
+    MaxRewindTime = 0.4f;
+    HitTolerance = 30.0f;
+
+    VulnerableBoneName = TEXT("head");
+    VulnerableRadius = 20.0f;
+
+    VulnerableMesh = nullptr;
+    bHasVulnerableBone = false;
+
+    HitboxRadius = 0.0f;
+    HitboxHalfHeight = 0.0f;
+
+    NewestSnapshotIndex = INDEX_NONE;
+    NumSnapshots = 0;
+}
+
+void UCSHitboxHistoryComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    // History is only needed on a server that has remote clients to validate
+    if (GetOwnerRole() < ROLE_Authority || GetNetMode() == NM_Standalone)
+        return;
+
+    AActor* MyOwner = GetOwner();
+    if (MyOwner == nullptr)
+        return;
+
+    float Radius = 0.0f;
+    float HalfHeight = 0.0f;
+
+    UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(MyOwner->GetRootComponent());
+    if (Capsule)
+    {
+        Radius = Capsule->GetScaledCapsuleRadius();
+        HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+    }
+    else
+    {
+        Radius = MyOwner->GetRootComponent() ? MyOwner->GetRootComponent()->Bounds.SphereRadius : 0.0f;
+        HalfHeight = Radius;
+    }
+
+    // Vulnerable hits are only confirmed against a bone the server animates itself
+    USkeletalMeshComponent* Mesh = MyOwner->FindComponentByClass<USkeletalMeshComponent>();
+    if (Mesh && Mesh->GetBoneIndex(VulnerableBoneName) != INDEX_NONE)
+        VulnerableMesh = Mesh;
+
+    InitHistory(Radius, HalfHeight, VulnerableMesh != nullptr);
+
+    SetComponentTickEnabled(true);
+}
+
+void UCSHitboxHistoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    RecordSnapshot();
+}
+
+void UCSHitboxHistoryComponent::RecordSnapshot()
+{
+    AActor* MyOwner = GetOwner();
+    if (MyOwner == nullptr)
+        return;
+
+    FCSHitboxSnapshot Snapshot;
+    Snapshot.Time = GetWorld()->GetTimeSeconds();
+    Snapshot.Location = MyOwner->GetActorLocation();
+    Snapshot.Rotation = MyOwner->GetActorQuat();
+
+    if (bHasVulnerableBone && VulnerableMesh)
+        Snapshot.VulnerableLocation = VulnerableMesh->GetBoneLocation(VulnerableBoneName);
+
+    AddSnapshot(Snapshot);
+}
+
+void UCSHitboxHistoryComponent::InitHistory(float Radius, float HalfHeight, bool bTrackVulnerableBone)
+{
+    HitboxRadius = Radius;
+    HitboxHalfHeight = HalfHeight;
+    bHasVulnerableBone = bTrackVulnerableBone;
+
+    Snapshots.SetNum(MaxSnapshots);
+
+    ClearHistory();
+}
+
+void UCSHitboxHistoryComponent::AddSnapshot(const FCSHitboxSnapshot& Snapshot)
+{
+    if (Snapshots.Num() == 0)
+        return;
+
+    NewestSnapshotIndex = (NewestSnapshotIndex + 1) % Snapshots.Num();
+    NumSnapshots = FMath::Min(NumSnapshots + 1, Snapshots.Num());
+
+    Snapshots[NewestSnapshotIndex] = Snapshot;
+}
+
+bool UCSHitboxHistoryComponent::GetSnapshotAtTime(float Time, FCSHitboxSnapshot& OutSnapshot) const
+{
+    if (NumSnapshots == 0)
+        return false;
+
+    const FCSHitboxSnapshot* Newer = &Snapshots[NewestSnapshotIndex];
+
+    if (Time >= Newer->Time)
+    {
+        OutSnapshot = *Newer;
+        return true;
+    }
+
+    // Walk back from the newest snapshot until we find the pair surrounding the requested time
+    for (int32 Step = 1; Step < NumSnapshots; ++Step)
+    {
+        const int32 Index = (NewestSnapshotIndex - Step + Snapshots.Num()) % Snapshots.Num();
+        const FCSHitboxSnapshot* Older = &Snapshots[Index];
+
+        if (Older->Time <= Time)
+        {
+            const float Span = Newer->Time - Older->Time;
+            const float Alpha = Span > KINDA_SMALL_NUMBER ? (Time - Older->Time) / Span : 1.0f;
+
+            OutSnapshot.Time = Time;
+            OutSnapshot.Location = FMath::Lerp(Older->Location, Newer->Location, Alpha);
+            OutSnapshot.Rotation = FQuat::Slerp(Older->Rotation, Newer->Rotation, Alpha);
+            OutSnapshot.VulnerableLocation = FMath::Lerp(Older->VulnerableLocation, Newer->VulnerableLocation, Alpha);
+            return true;
+        }
+
+        Newer = Older;
+    }
+
+    // Requested time is older than our history, use the oldest we have
+    OutSnapshot = *Newer;
+    return true;
+}
+
+bool UCSHitboxHistoryComponent::ConfirmHit(float Time, const FVector& TraceStart, const FVector& TraceEnd, const FVector& ImpactPoint, bool& bOutVulnerable) const
+{
+    bOutVulnerable = false;
+
+    FCSHitboxSnapshot Snapshot;
+    if (!GetSnapshotAtTime(Time, Snapshot))
+        return false;
+
+    const FVector Up = Snapshot.Rotation.GetUpVector();
+    const float AxisHalfLength = FMath::Max(HitboxHalfHeight - HitboxRadius, 0.0f);
+
+    const FVector AxisStart = Snapshot.Location - Up * AxisHalfLength;
+    const FVector AxisEnd = Snapshot.Location + Up * AxisHalfLength;
+
+    // The claimed impact has to be on the rewound hitbox...
+    if (FMath::PointDistToSegment(ImpactPoint, AxisStart, AxisEnd) > HitboxRadius + HitTolerance)
+        return false;
+
+    // ...and the claimed trace has to actually pass through it
+    return TraceHitbox(Snapshot, TraceStart, TraceEnd, bOutVulnerable);
+}
+
+bool UCSHitboxHistoryComponent::TraceHitbox(const FCSHitboxSnapshot& Snapshot, const FVector& TraceStart, const FVector& TraceEnd, bool& bOutVulnerable) const
+{
+    bOutVulnerable = false;
+
+    const FVector Up = Snapshot.Rotation.GetUpVector();
+    const float AxisHalfLength = FMath::Max(HitboxHalfHeight - HitboxRadius, 0.0f);
+
+    const FVector AxisStart = Snapshot.Location - Up * AxisHalfLength;
+    const FVector AxisEnd = Snapshot.Location + Up * AxisHalfLength;
+
+    FVector ClosestOnTrace;
+    FVector ClosestOnAxis;
+    FMath::SegmentDistToSegmentSafe(TraceStart, TraceEnd, AxisStart, AxisEnd, ClosestOnTrace, ClosestOnAxis);
+
+    if (FVector::Dist(ClosestOnTrace, ClosestOnAxis) > HitboxRadius + HitTolerance)
+        return false;
+
+    // The surface the client reports is never trusted, the trace has to pass through the rewound bone
+    if (bHasVulnerableBone)
+        bOutVulnerable = FMath::PointDistToSegment(Snapshot.VulnerableLocation, TraceStart, TraceEnd) <= VulnerableRadius;
+
+    return true;
+}
+
+float UCSHitboxHistoryComponent::GetMaxRewindTime() const
+{
+    return MaxRewindTime;
+}
+
+void UCSHitboxHistoryComponent::ClearHistory()
+{
+    NewestSnapshotIndex = INDEX_NONE;
+    NumSnapshots = 0;
+}
@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSActorPoolSubsystem.h"
+#include "CSPoolableActor.h"
+#include "CSTypes.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "TimerManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Actor Pool Spawn"), STAT_ActorPoolSpawn, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Pool Hits"), STAT_ActorPoolHits, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Pool Misses"), STAT_ActorPoolMisses, STATGROUP_Coop);
+
+UCSActorPoolSubsystem::UCSActorPoolSubsystem()
+{
+    MaxPooledPerClass = 64;
+}
+
+TStatId UCSActorPoolSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSActorPoolSubsystem, STATGROUP_Tickables);
+}
+
+AActor* UCSActorPoolSubsystem::Acquire(const UObject* WorldContextObject, UClass* ActorClass, const FTransform& Transform, AActor* Owner /*= nullptr*/, APawn* Instigator /*= nullptr*/)
+{
+    UCSActorPoolSubsystem* ActorPool = UCSWorldSubsystem::Get<UCSActorPoolSubsystem>(WorldContextObject);
+
+    if (ActorPool)
+        return ActorPool->AcquireActor(ActorClass, Transform, Owner, Instigator);
+
+    UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    if (World == nullptr || ActorClass == nullptr)
+        return nullptr;
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.Owner = Owner;
+    SpawnParams.Instigator = Instigator;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+    return World->SpawnActor(ActorClass, &Transform, SpawnParams);
+}
+
+void UCSActorPoolSubsystem::Release(AActor* Actor)
+{
+    if (!IsValid(Actor))
+        return;
+
+    UCSActorPoolSubsystem* ActorPool = UCSWorldSubsystem::Get<UCSActorPoolSubsystem>(Actor);
+
+    if (ActorPool)
+        ActorPool->ReleaseActor(Actor);
+    else
+        Actor->Destroy();
+}
+
+AActor* UCSActorPoolSubsystem::AcquireActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner /*= nullptr*/, APawn* Instigator /*= nullptr*/)
+{
+    if (ActorClass == nullptr)
+        return nullptr;
+
+    FCSActorPool* Pool = Pools.Find(ActorClass);
+
+    AActor* Actor = nullptr;
+
+    while (Pool && Pool->FreeActors.Num() > 0 && Actor == nullptr)
+    {
+        Actor = Pool->FreeActors.Pop(false);
+
+        if (!IsValid(Actor) || Actor->IsActorBeingDestroyed())
+            Actor = nullptr;
+    }
+
+    if (Actor == nullptr)
+    {
+        INC_DWORD_STAT(STAT_ActorPoolMisses);
+
+        return SpawnActor(ActorClass, Transform, Owner, Instigator);
+    }
+
+    INC_DWORD_STAT(STAT_ActorPoolHits);
+
+    Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+    Actor->SetOwner(Owner);
+    Actor->Instigator = Instigator;
+
+    Actor->SetActorHiddenInGame(false);
+    Actor->SetActorEnableCollision(true);
+    Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+    ICSPoolableActor* Poolable = Cast<ICSPoolableActor>(Actor);
+    if (Poolable)
+        Poolable->SetPooled(false);
+
+    if (Actor->GetIsReplicated())
+    {
+        Actor->SetNetDormancy(DORM_Awake);
+        Actor->ForceNetUpdate();
+    }
+
+    ICSPoolableActor::Execute_OnAcquiredFromPool(Actor);
+
+    return Actor;
+}
+
+void UCSActorPoolSubsystem::ReleaseActor(AActor* Actor)
+{
+    if (!IsValid(Actor) || Actor->IsActorBeingDestroyed())
+        return;
+
+    if (!Actor->GetClass()->ImplementsInterface(UCSPoolableActor::StaticClass()))
+    {
+        Actor->Destroy();
+        return;
+    }
+
+    FCSActorPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+
+    // Released twice, it would be handed out to two users at once
+    if (Pool.FreeActors.Contains(Actor))
+        return;
+
+    if (Pool.FreeActors.Num() >= MaxPooledPerClass)
+    {
+        Actor->Destroy();
+        return;
+    }
+
+    ICSPoolableActor::Execute_OnReleasedToPool(Actor);
+
+    DeactivateActor(Actor);
+
+    Pool.FreeActors.Add(Actor);
+}
+
+void UCSActorPoolSubsystem::Prewarm(UClass* ActorClass, int32 Count)
+{
+    if (ActorClass == nullptr || !ActorClass->ImplementsInterface(UCSPoolableActor::StaticClass()))
+        return;
+
+    FCSActorPool& Pool = Pools.FindOrAdd(ActorClass);
+
+    Count = FMath::Min(Count, MaxPooledPerClass);
+
+    while (Pool.FreeActors.Num() < Count)
+    {
+        AActor* Actor = SpawnActor(ActorClass, FTransform::Identity, nullptr, nullptr);
+
+        if (Actor == nullptr)
+            break;
+
+        ICSPoolableActor::Execute_OnReleasedToPool(Actor);
+
+        DeactivateActor(Actor);
+
+        Pool.FreeActors.Add(Actor);
+    }
+}
+
+AActor* UCSActorPoolSubsystem::SpawnActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+    UWorld* World = GetTickableGameObjectWorld();
+    if (World == nullptr)
+        return nullptr;
+
+    SCOPE_CYCLE_COUNTER(STAT_ActorPoolSpawn);
+
+    FActorSpawnParameters SpawnParams;
+    SpawnParams.Owner = Owner;
+    SpawnParams.Instigator = Instigator;
+    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+    return World->SpawnActor(ActorClass, &Transform, SpawnParams);
+}
+
+void UCSActorPoolSubsystem::DeactivateActor(AActor* Actor)
+{
+    Actor->GetWorldTimerManager().ClearAllTimersForObject(Actor);
+
+    Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+    Actor->SetOwner(nullptr);
+    Actor->Instigator = nullptr;
+
+    Actor->SetActorHiddenInGame(true);
+    Actor->SetActorEnableCollision(false);
+    Actor->SetActorTickEnabled(false);
+
+    // Collision isn't replicated, clients turn it off when they get the pooled flag
+    ICSPoolableActor* Poolable = Cast<ICSPoolableActor>(Actor);
+    if (Poolable)
+        Poolable->SetPooled(true);
+
+    // Clients get the hidden state, then the actor stops replicating until it is acquired again.
+    // Flushed for actors that were already dormant while in use
+    if (Actor->GetIsReplicated())
+    {
+        Actor->SetNetDormancy(DORM_DormantAll);
+        Actor->FlushNetDormancy();
+    }
+}
+
+void UCSActorPoolSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    Pools.Reset();
+}
@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSEffectPoolSubsystem.h"
+#include "CSTypes.h"
+
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Pool Hits"), STAT_EffectPoolHits, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Pool Misses"), STAT_EffectPoolMisses, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Pool Recycled Impacts"), STAT_EffectPoolRecycledImpacts, STATGROUP_Coop);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Free Components"), STAT_EffectPoolFreeComponents, STATGROUP_Coop);
+
+UCSEffectPoolSubsystem::UCSEffectPoolSubsystem()
+{
+    MaxPooledPerTemplate = 32;
+    MaxImpactsPerSurface = 24;
+}
+
+TStatId UCSEffectPoolSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSEffectPoolSubsystem, STATGROUP_Tickables);
+}
+
+UParticleSystemComponent* UCSEffectPoolSubsystem::PlayEffectAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation /*= FRotator::ZeroRotator*/, EPhysicalSurface SurfaceType /*= SurfaceType_Max*/)
+{
+    UCSEffectPoolSubsystem* EffectPool = UCSWorldSubsystem::Get<UCSEffectPoolSubsystem>(WorldContextObject);
+
+    if (EffectPool)
+        return EffectPool->SpawnEffectAtLocation(Template, Location, Rotation, SurfaceType);
+
+    return UGameplayStatics::SpawnEmitterAtLocation(WorldContextObject, Template, Location, Rotation);
+}
+
+UParticleSystemComponent* UCSEffectPoolSubsystem::PlayEffectAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName /*= NAME_None*/)
+{
+    UCSEffectPoolSubsystem* EffectPool = UCSWorldSubsystem::Get<UCSEffectPoolSubsystem>(AttachToComponent);
+
+    if (EffectPool)
+        return EffectPool->SpawnEffectAttached(Template, AttachToComponent, AttachPointName);
+
+    return UGameplayStatics::SpawnEmitterAttached(Template, AttachToComponent, AttachPointName);
+}
+
+UParticleSystemComponent* UCSEffectPoolSubsystem::SpawnEffectAtLocation(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation /*= FRotator::ZeroRotator*/, EPhysicalSurface SurfaceType /*= SurfaceType_Max*/)
+{
+    // Nobody is watching on a dedicated server
+    if (Template == nullptr || IsRunningDedicatedServer())
+        return nullptr;
+
+    if (SurfaceType < SurfaceType_Max)
+    {
+        TArray<TWeakObjectPtr<UParticleSystemComponent>>& SurfaceImpacts = LiveImpacts[SurfaceType];
+
+        SurfaceImpacts.RemoveAll([](const TWeakObjectPtr<UParticleSystemComponent>& Impact)
+        {
+            return !Impact.IsValid() || !Impact->IsActive();
+        });
+
+        // Too many impacts on this surface, cut the oldest one short
+        if (SurfaceImpacts.Num() >= MaxImpactsPerSurface)
+        {
+            UParticleSystemComponent* OldestImpact = SurfaceImpacts[0].Get();
+            SurfaceImpacts.RemoveAt(0, 1, false);
+
+            OldestImpact->DeactivateImmediate();
+            ReleaseEffect(OldestImpact);
+
+            INC_DWORD_STAT(STAT_EffectPoolRecycledImpacts);
+        }
+    }
+
+    UParticleSystemComponent* Effect = AcquireEffect(Template, Location, Rotation);
+
+    if (Effect && SurfaceType < SurfaceType_Max)
+        LiveImpacts[SurfaceType].Add(Effect);
+
+    return Effect;
+}
+
+UParticleSystemComponent* UCSEffectPoolSubsystem::SpawnEffectAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName /*= NAME_None*/)
+{
+    if (Template == nullptr || AttachToComponent == nullptr || IsRunningDedicatedServer())
+        return nullptr;
+
+    UParticleSystemComponent* Effect = AcquireEffect(Template, AttachToComponent->GetSocketLocation(AttachPointName), AttachToComponent->GetSocketRotation(AttachPointName));
+
+    if (Effect)
+        Effect->AttachToComponent(AttachToComponent, FAttachmentTransformRules::SnapToTargetNotIncludingScale, AttachPointName);
+
+    return Effect;
+}
+
+UParticleSystemComponent* UCSEffectPoolSubsystem::AcquireEffect(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+    FCSEffectPool& Pool = Pools.FindOrAdd(Template);
+
+    while (Pool.FreeComponents.Num() > 0)
+    {
+        UParticleSystemComponent* Effect = Pool.FreeComponents.Pop(false);
+        DEC_DWORD_STAT(STAT_EffectPoolFreeComponents);
+
+        if (!IsValid(Effect) || Effect->IsBeingDestroyed())
+            continue;
+
+        INC_DWORD_STAT(STAT_EffectPoolHits);
+
+        // Parameters like BeamEnd belong to the previous user
+        Effect->InstanceParameters.Reset();
+
+        Effect->SetWorldLocationAndRotation(Location, Rotation);
+        Effect->SetHiddenInGame(false);
+        Effect->ActivateSystem(true);
+
+        return Effect;
+    }
+
+    INC_DWORD_STAT(STAT_EffectPoolMisses);
+
+    UParticleSystemComponent* Effect = UGameplayStatics::SpawnEmitterAtLocation(GetTickableGameObjectWorld(), Template, Location, Rotation, false);
+
+    if (Effect)
+        Effect->OnSystemFinished.AddUniqueDynamic(this, &UCSEffectPoolSubsystem::OnEffectFinished);
+
+    return Effect;
+}
+
+void UCSEffectPoolSubsystem::ReleaseEffect(UParticleSystemComponent* Effect)
+{
+    if (!IsValid(Effect) || Effect->Template == nullptr)
+        return;
+
+    FCSEffectPool* Pool = Pools.Find(Effect->Template);
+
+    if (Pool == nullptr || Pool->FreeComponents.Contains(Effect))
+        return;
+
+    if (Effect->GetAttachParent())
+        Effect->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+
+    if (Pool->FreeComponents.Num() >= MaxPooledPerTemplate)
+    {
+        Effect->DestroyComponent();
+        return;
+    }
+
+    Effect->SetHiddenInGame(true);
+
+    Pool->FreeComponents.Add(Effect);
+    INC_DWORD_STAT(STAT_EffectPoolFreeComponents);
+}
+
+void UCSEffectPoolSubsystem::OnEffectFinished(UParticleSystemComponent* Effect)
+{
+    ReleaseEffect(Effect);
+}
+
+void UCSEffectPoolSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    // Components belong to the world going away
+    for (TPair<UParticleSystem*, FCSEffectPool>& Pair : Pools)
+        DEC_DWORD_STAT_BY(STAT_EffectPoolFreeComponents, Pair.Value.FreeComponents.Num());
+
+    Pools.Reset();
+
+    for (TArray<TWeakObjectPtr<UParticleSystemComponent>>& SurfaceImpacts : LiveImpacts)
+        SurfaceImpacts.Reset();
+}
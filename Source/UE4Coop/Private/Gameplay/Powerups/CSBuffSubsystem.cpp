@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSBuffSubsystem.h"
+#include "CSPowerUpBase.h"
+#include "CSTypes.h"
+
+#include "Algo/BinarySearch.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Buff Scheduler"), STAT_BuffScheduler, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Buff Ticks"), STAT_BuffTicks, STATGROUP_Coop);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Buffs"), STAT_ActiveBuffs, STATGROUP_Coop);
+
+void UCSBuffSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    SET_DWORD_STAT(STAT_ActiveBuffs, Buffs.Num());
+
+    UWorld* World = GetTickableGameObjectWorld();
+    if (Buffs.Num() == 0 || World == nullptr)
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_BuffScheduler);
+
+    const float Now = World->GetTimeSeconds();
+
+    int32 NumDue = 0;
+    while (NumDue < Buffs.Num() && Buffs[NumDue].NextTickTime <= Now)
+        NumDue++;
+
+    if (NumDue == 0)
+        return;
+
+    DueBuffs.Reset();
+    DueBuffs.Append(Buffs.GetData(), NumDue);
+    Buffs.RemoveAt(0, NumDue, false);
+
+    // A power up tick can release other power ups, RemoveBuff clears their entry here
+    for (int32 Index = 0; Index < DueBuffs.Num(); ++Index)
+    {
+        ACSPowerUpBase* PowerUp = DueBuffs[Index].PowerUp;
+        if (PowerUp == nullptr)
+            continue;
+
+        INC_DWORD_STAT(STAT_BuffTicks);
+
+        if (!PowerUp->TickPowerUp() || DueBuffs[Index].PowerUp == nullptr)
+            continue;
+
+        FCSActiveBuff Buff = DueBuffs[Index];
+        Buff.NextTickTime += PowerUp->PeriodicTimer;
+        InsertBuff(Buff);
+    }
+
+    DueBuffs.Reset();
+}
+
+TStatId UCSBuffSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSBuffSubsystem, STATGROUP_Tickables);
+}
+
+void UCSBuffSubsystem::AddBuff(ACSPowerUpBase* PowerUp)
+{
+    UWorld* World = GetTickableGameObjectWorld();
+    if (PowerUp == nullptr || World == nullptr)
+        return;
+
+    FCSActiveBuff Buff;
+    Buff.PowerUp = PowerUp;
+    Buff.NextTickTime = World->GetTimeSeconds() + PowerUp->PeriodicTimer;
+
+    InsertBuff(Buff);
+}
+
+void UCSBuffSubsystem::RemoveBuff(ACSPowerUpBase* PowerUp)
+{
+    const int32 Index = Buffs.IndexOfByPredicate([PowerUp](const FCSActiveBuff& Buff) { return Buff.PowerUp == PowerUp; });
+    if (Index != INDEX_NONE)
+        Buffs.RemoveAt(Index, 1, false);
+
+    for (FCSActiveBuff& Buff : DueBuffs)
+    {
+        if (Buff.PowerUp == PowerUp)
+            Buff.PowerUp = nullptr;
+    }
+}
+
+ACSPowerUpBase* UCSBuffSubsystem::FindBuff(UClass* PowerUpClass, const ACSCharacter* Target) const
+{
+    for (const FCSActiveBuff& Buff : Buffs)
+    {
+        if (Buff.PowerUp->GetClass() == PowerUpClass && Buff.PowerUp->Target == Target)
+            return Buff.PowerUp;
+    }
+
+    return nullptr;
+}
+
+int32 UCSBuffSubsystem::GetNumBuffs() const
+{
+    return Buffs.Num();
+}
+
+void UCSBuffSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    Buffs.Reset();
+    DueBuffs.Reset();
+}
+
+void UCSBuffSubsystem::InsertBuff(const FCSActiveBuff& Buff)
+{
+    // After the buffs due at the same time, so equal periods keep their activation order
+    const int32 Index = Algo::UpperBoundBy(Buffs, Buff.NextTickTime, &FCSActiveBuff::NextTickTime);
+    Buffs.Insert(Buff, Index);
+}
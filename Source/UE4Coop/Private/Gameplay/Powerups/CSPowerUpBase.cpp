@@ -3,56 +3,133 @@
 
 #include "CSPowerUpBase.h"
 #include "CSCharacter.h"
+#include "CSActorPoolSubsystem.h"
+#include "CSBuffSubsystem.h"
 #include "Net/UnrealNetwork.h"
 
 // Sets default values
 ACSPowerUpBase::ACSPowerUpBase()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+    // Only changes state on activation and expiry, periodic ticks run in the buff subsystem
+    PrimaryActorTick.bCanEverTick = false;
 
     PeriodicTimer = 0;
     TotalNumberOfTicks = 0;
+    TicksCounter = 0;
+    bHasTickEvent = false;
     bIsPowerUpActive = false;
+    bPooled = false;
+
+    Stacking = ECSBuffStacking::Stack;
 
     SetReplicates(true);
+
+    // Woken by a flush when bIsPowerUpActive changes
+    NetDormancy = DORM_DormantAll;
+}
+
+void ACSPowerUpBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UCSBuffSubsystem* BuffSubsystem = UCSWorldSubsystem::Get<UCSBuffSubsystem>(this);
+    if (BuffSubsystem)
+        BuffSubsystem->RemoveBuff(this);
+
+    Super::EndPlay(EndPlayReason);
 }
 
-void ACSPowerUpBase::OnTick()
+bool ACSPowerUpBase::TickPowerUp()
 {
     TicksCounter++;
 
-    OnPowerUpTicked();
+    if (bHasTickEvent)
+        OnPowerUpTicked();
 
-    if (TicksCounter >= TotalNumberOfTicks)
-    {
-        OnExpired();
+    if (TicksCounter < TotalNumberOfTicks)
+        return true;
 
-        bIsPowerUpActive = false;
-        OnRep_PowerUpActive();
+    OnExpired();
 
-        // Stop the timer
-        GetWorldTimerManager().ClearTimer(TimerHandle_PowerUpTick);
+    bIsPowerUpActive = false;
+    OnRep_PowerUpActive();
 
-        Target = nullptr;
-    }
+    Target = nullptr;
+
+    // [server] wait in the pool for the next respawn, this also takes the power up out of the buff subsystem
+    if (HasAuthority())
+        UCSActorPoolSubsystem::Release(this);
+
+    return false;
 }
 
 void ACSPowerUpBase::Activate(ACSCharacter* TargetPawn)
 {
+    UCSBuffSubsystem* BuffSubsystem = UCSWorldSubsystem::Get<UCSBuffSubsystem>(this);
+
+    ACSPowerUpBase* ActiveBuff = (BuffSubsystem && Stacking != ECSBuffStacking::Stack) ? BuffSubsystem->FindBuff(GetClass(), TargetPawn) : nullptr;
+    if (ActiveBuff)
+    {
+        if (Stacking == ECSBuffStacking::Refresh)
+            ActiveBuff->TicksCounter = 0;
+
+        if (HasAuthority())
+            UCSActorPoolSubsystem::Release(this);
+
+        return;
+    }
+
     Target = TargetPawn;
 
+    bHasTickEvent = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(ACSPowerUpBase, OnPowerUpTicked));
+
     OnActivated();
 
     bIsPowerUpActive = true;
     OnRep_PowerUpActive();
 
-    if (PeriodicTimer)
+    if (HasAuthority())
+        FlushNetDormancy();
+
+    if (PeriodicTimer > 0.0f && BuffSubsystem)
+        BuffSubsystem->AddBuff(this);
+    else
+        TickPowerUp();
+}
+
+void ACSPowerUpBase::OnAcquiredFromPool_Implementation()
+{
+    TicksCounter = 0;
+    Target = nullptr;
+
+    // Replicate the respawn, then stay dormant until the power up is picked up
+    if (HasAuthority())
+        SetNetDormancy(DORM_DormantAll);
+}
+
+void ACSPowerUpBase::OnReleasedToPool_Implementation()
+{
+    UCSBuffSubsystem* BuffSubsystem = UCSWorldSubsystem::Get<UCSBuffSubsystem>(this);
+    if (BuffSubsystem)
+        BuffSubsystem->RemoveBuff(this);
+
+    TicksCounter = 0;
+    Target = nullptr;
+
+    if (bIsPowerUpActive)
     {
-        GetWorldTimerManager().SetTimer(TimerHandle_PowerUpTick, this, &ACSPowerUpBase::OnTick, PeriodicTimer, true);
+        bIsPowerUpActive = false;
+        OnRep_PowerUpActive();
     }
-    else
-        OnTick();
+}
+
+void ACSPowerUpBase::SetPooled(bool bNewPooled)
+{
+    bPooled = bNewPooled;
+    OnRep_Pooled();
+}
+
+void ACSPowerUpBase::OnRep_Pooled()
+{
+    SetActorEnableCollision(!bPooled);
 }
 
 void ACSPowerUpBase::OnRep_PowerUpActive()
@@ -65,4 +142,5 @@ void ACSPowerUpBase::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
     Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
     DOREPLIFETIME(ACSPowerUpBase, bIsPowerUpActive);
+    DOREPLIFETIME(ACSPowerUpBase, bPooled);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "CSPowerUpSpawner.h"
 #include "CSPowerUpBase.h"
 #include "CSCharacter.h"
+#include "CSActorPoolSubsystem.h"
 #include "Components/DecalComponent.h"
 #include "Components/SphereComponent.h"
 #include "TimerManager.h"
@@ -11,8 +12,8 @@
 // Sets default values
 ACSPowerUpSpawner::ACSPowerUpSpawner()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+    // Reacts to overlaps, the respawn runs on a timer
+    PrimaryActorTick.bCanEverTick = false;
 
     SphereComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
     SphereComp->SetSphereRadius(75.0f);
@@ -24,6 +25,9 @@ ACSPowerUpSpawner::ACSPowerUpSpawner()
     DecalComp->SetupAttachment(RootComponent);
 
     SetReplicates(true);
+
+    // Nothing on the spawner changes at runtime, clients get it from the level
+    NetDormancy = DORM_Initial;
 }
 
 // Called when the game starts or when spawned
@@ -67,8 +71,5 @@ void ACSPowerUpSpawner::Respawn()
         return;
     }
 
-    FActorSpawnParameters SpawnParams;
-    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-
-    PowerUpInstance = GetWorld()->SpawnActor<ACSPowerUpBase>(PowerUpClass, GetTransform(), SpawnParams);
+    PowerUpInstance = UCSActorPoolSubsystem::Acquire<ACSPowerUpBase>(this, PowerUpClass, GetTransform());
 }
\ No newline at end of file
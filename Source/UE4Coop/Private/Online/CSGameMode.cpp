@@ -6,6 +6,7 @@
 #include "CSCharacter.h"
 #include "CSPlayerState.h"
 #include "CSGameInstance.h"
+#include "CSActorPoolSubsystem.h"
 
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerState.h"
@@ -35,6 +36,8 @@ ACSGameMode::ACSGameMode()
 
     CurrentRound = 0;
 
+    bRoundStateDirty = false;
+
     PreRoundDuration = 10.f;
     PostRoundDuration = 5.f;
 }
@@ -76,6 +79,8 @@ void ACSGameMode::EndMatch()
 
 void ACSGameMode::OnMatchStateSet()
 {
+    MarkRoundStateDirty();
+
     // Copy and override from GameMode.cpp
     FGameModeEvents::OnGameModeMatchStateSetEvent().Broadcast(MatchState);
 
@@ -174,6 +179,13 @@ void ACSGameMode::HandleRoundIsStarting()
     CurrentRound++;
 
     CSGameState->SetCurrentRound(CurrentRound);
+
+    UCSActorPoolSubsystem* ActorPool = UCSWorldSubsystem::Get<UCSActorPoolSubsystem>(this);
+    if (ActorPool)
+    {
+        for (const TPair<TSubclassOf<AActor>, int32>& Prewarmed : PrewarmedActors)
+            ActorPool->Prewarm(Prewarmed.Key, Prewarmed.Value);
+    }
 }
 
 bool ACSGameMode::ReadyToStartRound_Implementation()
@@ -279,6 +291,12 @@ void ACSGameMode::Tick(float DeltaSeconds)
         }
     }
 
+    // Round and match end only need checking once something they depend on changed
+    if (!bRoundStateDirty)
+        return;
+
+    bRoundStateDirty = false;
+
     if (GetMatchState() == MatchState::RoundInProgress)
     {
         // Check to see if we should end the round
@@ -306,6 +324,41 @@ void ACSGameMode::Tick(float DeltaSeconds)
     }
 }
 
+void ACSGameMode::MarkRoundStateDirty()
+{
+    bRoundStateDirty = true;
+}
+
+void ACSGameMode::UpdateLiveCounter(ECSLiveCounter& Counter, ECSLiveCounter NewCounter)
+{
+    if (!LiveCounters.Update(Counter, NewCounter))
+        return;
+
+    ensure(LiveCounters.NumBots >= 0 && LiveCounters.NumPlayers >= 0);
+
+    MarkRoundStateDirty();
+}
+
+bool FCSLiveCounters::Update(ECSLiveCounter& Counter, ECSLiveCounter NewCounter)
+{
+    if (NewCounter == Counter)
+        return false;
+
+    if (Counter == ECSLiveCounter::Bot)
+        NumBots--;
+    else if (Counter == ECSLiveCounter::Player)
+        NumPlayers--;
+
+    if (NewCounter == ECSLiveCounter::Bot)
+        NumBots++;
+    else if (NewCounter == ECSLiveCounter::Player)
+        NumPlayers++;
+
+    Counter = NewCounter;
+
+    return true;
+}
+
 void ACSGameMode::LoadMainMenuMap()
 {
     UCSGameInstance* GI = GetWorld()->GetGameInstance<UCSGameInstance>();
@@ -319,6 +372,16 @@ bool ACSGameMode::IsFriendlyFireAllowed()
     return bAllowFriendlyFire;
 }
 
+ECSTeamAttitude ACSGameMode::GetTeamAttitude(uint8 TeamA, uint8 TeamB) const
+{
+    return TeamAttitudes.GetAttitude(TeamA, TeamB);
+}
+
+void ACSGameMode::SetTeamAttitude(uint8 TeamA, uint8 TeamB, ECSTeamAttitude Attitude, bool bSymmetric)
+{
+    TeamAttitudes.SetAttitude(TeamA, TeamB, Attitude, bSymmetric);
+}
+
 void ACSGameMode::Killed(AController* Killer, AController* KilledPlayer, APawn* KilledPawn, const UDamageType* DamageType)
 {
     ACSPlayerState* KillerPlayerState = Killer ? Cast<ACSPlayerState>(Killer->PlayerState) : nullptr;
@@ -332,6 +395,9 @@ void ACSGameMode::Killed(AController* Killer, AController* KilledPlayer, APawn*
 
 void ACSGameMode::TickGameTime()
 {
+    // Blueprint overrides of the end conditions may depend on anything, give them a chance every second
+    MarkRoundStateDirty();
+
     if (CSGameState)
     {
         float TimeRemaining = CSGameState->GetTimeRemaining() - 1;
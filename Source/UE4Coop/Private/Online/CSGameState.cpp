@@ -3,6 +3,9 @@
 
 #include "CSGameState.h"
 #include "CSGameMode.h"
+#include "CSWeaponStatsSubsystem.h"
+
+#include "Engine/GameInstance.h"
 
 #include "Net/UnrealNetwork.h"
 
@@ -38,6 +41,25 @@ void ACSGameState::SetPlayerWinner(bool bPlayerWon)
     bPlayerWinner = bPlayerWon;
 }
 
+void ACSGameState::AddWeaponStatsOverrides(const TArray<FCSWeaponStatsOverride>& Overrides)
+{
+    if (Role != ENetRole::ROLE_Authority)
+        return;
+
+    for (const FCSWeaponStatsOverride& Override : Overrides)
+    {
+        FCSWeaponStatsOverride* Existing = WeaponStatsOverrides.FindByPredicate([&Override](const FCSWeaponStatsOverride& Other)
+        {
+            return Other.RowName == Override.RowName;
+        });
+
+        if (Existing)
+            *Existing = Override;
+        else
+            WeaponStatsOverrides.Add(Override);
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Reading Data
 
@@ -81,6 +103,15 @@ void ACSGameState::OnRep_MatchState()
     OnMatchStateChanged.Broadcast(PreviousMatchState, MatchState);
 }
 
+void ACSGameState::OnRep_WeaponStatsOverrides()
+{
+    UGameInstance* GameInstance = GetGameInstance();
+    UCSWeaponStatsSubsystem* WeaponStats = GameInstance ? GameInstance->GetSubsystem<UCSWeaponStatsSubsystem>() : nullptr;
+
+    if (WeaponStats)
+        WeaponStats->LoadOverrides(WeaponStatsOverrides);
+}
+
 void ACSGameState::GetLifetimeReplicatedProps(TArray< FLifetimeProperty >& OutLifetimeProps) const
 {
     Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -90,4 +121,5 @@ void ACSGameState::GetLifetimeReplicatedProps(TArray< FLifetimeProperty >& OutLi
     DOREPLIFETIME(ACSGameState, MaxRounds);
     DOREPLIFETIME(ACSGameState, CurrentRound);
     DOREPLIFETIME(ACSGameState, bPlayerWinner);
+    DOREPLIFETIME(ACSGameState, WeaponStatsOverrides);
 }
@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSReplicationGraph.h"
+#include "CSCharacter.h"
+#include "CSTrackerBot.h"
+#include "CSWeapon.h"
+#include "CSPowerUpBase.h"
+#include "CSPowerUpSpawner.h"
+#include "ReplicationGraphTypes.h"
+#include "Engine/LevelScriptActor.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/Info.h"
+#include "UObject/UObjectIterator.h"
+
+UCSReplicationGraph::UCSReplicationGraph()
+{
+    GridCellSize = 10000.0f;
+    SpatialBias = FVector2D(-150000.0f, -200000.0f);
+
+    BotCullDistance = 15000.0f;
+    CharacterCullDistance = 20000.0f;
+    PowerUpCullDistance = 10000.0f;
+
+    GridNode = nullptr;
+    AlwaysRelevantNode = nullptr;
+}
+
+void UCSReplicationGraph::InitGlobalActorClassSettings()
+{
+    Super::InitGlobalActorClassSettings();
+
+    // Game rules, every class not listed here is routed from its replication flags
+    ClassRepNodePolicies.Set(AInfo::StaticClass(), ECSClassRepNodeMapping::RelevantAllConnections);
+    ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), ECSClassRepNodeMapping::NotRouted);
+    ClassRepNodePolicies.Set(ACSCharacter::StaticClass(), ECSClassRepNodeMapping::Spatialize_Dynamic);
+    ClassRepNodePolicies.Set(ACSTrackerBot::StaticClass(), ECSClassRepNodeMapping::Spatialize_Dynamic);
+    ClassRepNodePolicies.Set(ACSPowerUpBase::StaticClass(), ECSClassRepNodeMapping::Spatialize_Dormancy);
+    ClassRepNodePolicies.Set(ACSPowerUpSpawner::StaticClass(), ECSClassRepNodeMapping::Spatialize_Static);
+
+    // Weapons replicate as dependents of their owner, pooled weapons without one are not replicated at all
+    ClassRepNodePolicies.Set(ACSWeapon::StaticClass(), ECSClassRepNodeMapping::NotRouted);
+
+    const float ServerMaxTickRate = NetDriver ? (float)NetDriver->NetServerMaxTickRate : 30.0f;
+
+    for (TObjectIterator<UClass> It; It; ++It)
+    {
+        UClass* Class = *It;
+
+        const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+        if (!ActorCDO || !ActorCDO->GetIsReplicated())
+            continue;
+
+        // Skip blueprint compilation leftovers
+        const FString ClassName = Class->GetName();
+        if (ClassName.StartsWith(TEXT("SKEL_")) || ClassName.StartsWith(TEXT("REINST_")))
+            continue;
+
+        if (!ClassRepNodePolicies.Contains(Class, true))
+            ClassRepNodePolicies.Set(Class, GetDefaultMappingPolicy(ActorCDO));
+
+        FClassReplicationInfo ClassInfo;
+        ClassInfo.ReplicationPeriodFrame = FMath::Max<uint32>((uint32)FMath::RoundToFloat(ServerMaxTickRate / ActorCDO->NetUpdateFrequency), 1);
+        ClassInfo.CullDistanceSquared = ActorCDO->NetCullDistanceSquared;
+
+        if (Class->IsChildOf(ACSTrackerBot::StaticClass()))
+            ClassInfo.CullDistanceSquared = FMath::Square(BotCullDistance);
+        else if (Class->IsChildOf(ACSCharacter::StaticClass()))
+            ClassInfo.CullDistanceSquared = FMath::Square(CharacterCullDistance);
+        else if (Class->IsChildOf(ACSPowerUpBase::StaticClass()) || Class->IsChildOf(ACSPowerUpSpawner::StaticClass()))
+            ClassInfo.CullDistanceSquared = FMath::Square(PowerUpCullDistance);
+
+        GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+    }
+}
+
+void UCSReplicationGraph::InitGlobalGraphNodes()
+{
+    Super::InitGlobalGraphNodes();
+
+    GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+    GridNode->CellSize = GridCellSize;
+    GridNode->SpatialBias = SpatialBias;
+    AddGlobalGraphNode(GridNode);
+
+    AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+    AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UCSReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+    Super::InitConnectionGraphNodes(RepGraphConnection);
+
+    // The connection's own controller and view target, these are the only actors relevant to their owner
+    UReplicationGraphNode_AlwaysRelevant_ForConnection* AlwaysRelevantForConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+    AddConnectionGraphNode(AlwaysRelevantForConnectionNode, RepGraphConnection);
+}
+
+void UCSReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+    switch (GetMappingPolicy(ActorInfo.Class))
+    {
+    case ECSClassRepNodeMapping::RelevantAllConnections:
+        AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+        break;
+
+    case ECSClassRepNodeMapping::Spatialize_Static:
+        GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+        break;
+
+    case ECSClassRepNodeMapping::Spatialize_Dynamic:
+        GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+        break;
+
+    case ECSClassRepNodeMapping::Spatialize_Dormancy:
+        GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void UCSReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+    switch (GetMappingPolicy(ActorInfo.Class))
+    {
+    case ECSClassRepNodeMapping::RelevantAllConnections:
+        AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+        break;
+
+    case ECSClassRepNodeMapping::Spatialize_Static:
+        GridNode->RemoveActor_Static(ActorInfo);
+        break;
+
+    case ECSClassRepNodeMapping::Spatialize_Dynamic:
+        GridNode->RemoveActor_Dynamic(ActorInfo);
+        break;
+
+    case ECSClassRepNodeMapping::Spatialize_Dormancy:
+        GridNode->RemoveActor_Dormancy(ActorInfo);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void UCSReplicationGraph::OnWeaponOwnerChanged(ACSWeapon* Weapon, AActor* OldPawn, AActor* NewPawn)
+{
+    if (Weapon == nullptr)
+        return;
+
+    UWorld* World = Weapon->GetWorld();
+    UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+    UCSReplicationGraph* Graph = NetDriver ? NetDriver->GetReplicationDriver<UCSReplicationGraph>() : nullptr;
+    if (!Graph)
+        return;
+
+    // Pooled weapons are acquired already owned by their pawn, so always remove before adding instead of comparing
+    if (OldPawn)
+        Graph->GlobalActorReplicationInfoMap.RemoveDependentActor(OldPawn, Weapon);
+
+    if (NewPawn)
+        Graph->GlobalActorReplicationInfoMap.AddDependentActor(NewPawn, Weapon);
+}
+
+ECSClassRepNodeMapping UCSReplicationGraph::GetMappingPolicy(UClass* Class)
+{
+    const ECSClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class);
+    return Policy ? *Policy : ECSClassRepNodeMapping::NotRouted;
+}
+
+ECSClassRepNodeMapping UCSReplicationGraph::GetDefaultMappingPolicy(const AActor* ActorCDO)
+{
+    // Owner only actors are picked up by the per connection node
+    if (ActorCDO->bOnlyRelevantToOwner)
+        return ECSClassRepNodeMapping::NotRouted;
+
+    if (ActorCDO->bAlwaysRelevant)
+        return ECSClassRepNodeMapping::RelevantAllConnections;
+
+    const USceneComponent* RootComponent = ActorCDO->GetRootComponent();
+    if (RootComponent && RootComponent->Mobility == EComponentMobility::Static)
+        return ECSClassRepNodeMapping::Spatialize_Static;
+
+    return ActorCDO->NetDormancy >= DORM_DormantAll ? ECSClassRepNodeMapping::Spatialize_Dormancy : ECSClassRepNodeMapping::Spatialize_Dynamic;
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSTeamAttitude.h"
+
+FCSTeamAttitudeMatrix::FCSTeamAttitudeMatrix()
+{
+    Reset();
+}
+
+ECSTeamAttitude FCSTeamAttitudeMatrix::GetAttitude(uint8 TeamA, uint8 TeamB) const
+{
+    const int32 Index = (int32(TeamA) << 8) | TeamB;
+    const uint64 Mask = uint64(1) << (Index & 63);
+
+    if (AlliedBits[Index >> 6] & Mask)
+        return ECSTeamAttitude::Allied;
+
+    if (HostileBits[Index >> 6] & Mask)
+        return ECSTeamAttitude::Hostile;
+
+    return ECSTeamAttitude::Neutral;
+}
+
+void FCSTeamAttitudeMatrix::SetAttitude(uint8 TeamA, uint8 TeamB, ECSTeamAttitude Attitude, bool bSymmetric)
+{
+    SetPairAttitude(TeamA, TeamB, Attitude);
+
+    if (bSymmetric)
+        SetPairAttitude(TeamB, TeamA, Attitude);
+}
+
+void FCSTeamAttitudeMatrix::Reset()
+{
+    FMemory::Memzero(AlliedBits, sizeof(AlliedBits));
+    FMemory::Memset(HostileBits, 0xFF, sizeof(HostileBits));
+
+    for (int32 Team = 0; Team < NumTeams; ++Team)
+        SetPairAttitude(Team, Team, ECSTeamAttitude::Allied);
+}
+
+void FCSTeamAttitudeMatrix::SetPairAttitude(uint8 TeamA, uint8 TeamB, ECSTeamAttitude Attitude)
+{
+    const int32 Index = (int32(TeamA) << 8) | TeamB;
+    const uint64 Mask = uint64(1) << (Index & 63);
+
+    AlliedBits[Index >> 6] &= ~Mask;
+    HostileBits[Index >> 6] &= ~Mask;
+
+    if (Attitude == ECSTeamAttitude::Allied)
+        AlliedBits[Index >> 6] |= Mask;
+    else if (Attitude == ECSTeamAttitude::Hostile)
+        HostileBits[Index >> 6] |= Mask;
+}
@@ -2,7 +2,7 @@
 
 
 #include "CSWaveGameMode.h"
-#include "CSHealthComponent.h"
+#include "CSActorPoolSubsystem.h"
 
 //////////////////////////////////////////////////////////////////////////
 // Wave System (round based)
@@ -12,6 +12,10 @@ void ACSWaveGameMode::HandleRoundIsStarting()
     Super::HandleRoundIsStarting();
 
     NumberOfBotsToSpawn = 2 * GetCurrentRound();
+
+    UCSActorPoolSubsystem* ActorPool = UCSWorldSubsystem::Get<UCSActorPoolSubsystem>(this);
+    if (ActorPool && BotClass)
+        ActorPool->Prewarm(BotClass, NumberOfBotsToSpawn);
 }
 
 void ACSWaveGameMode::HandleRoundHasStarted()
@@ -34,27 +38,7 @@ bool ACSWaveGameMode::ReadyToEndRound_Implementation()
     if (NumberOfBotsToSpawn > 0)
         return false;
 
-    bool bIsAnyBotAlive = false;
-
-    for (FConstPawnIterator Iterator = GetWorld()->GetPawnIterator(); Iterator; ++Iterator)
-    {
-        APawn* Pawn = Iterator->Get();
-        if (Pawn == nullptr || Pawn->IsPlayerControlled())
-            continue;
-
-        UCSHealthComponent* HealthComp = Cast<UCSHealthComponent>(Pawn->GetComponentByClass(UCSHealthComponent::StaticClass()));
-
-        if (HealthComp == nullptr)
-            continue;
-
-        if (HealthComp->GetHealth() > 0.0f)
-        {
-            bIsAnyBotAlive = true;
-            break;
-        }
-    }
-
-    return !bIsAnyBotAlive;
+    return GetNumLiveBots() == 0;
 }
 
 bool ACSWaveGameMode::ReadyToEndMatch_Implementation()
@@ -69,29 +53,7 @@ bool ACSWaveGameMode::ReadyToEndMatch_Implementation()
         // TODO: COCO don't like this
         bPlayerWinner = false;
 
-        bReadyToEndMatch = true;
-
-        for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
-        {
-            APlayerController* PC = It->Get();
-
-            if (PC == nullptr)
-                continue;
-
-            APawn* PlayerPawn = PC->GetPawn();
-
-            if (PlayerPawn == nullptr)
-                continue;
-
-            UCSHealthComponent* HealthComp =
-                Cast<UCSHealthComponent>(PlayerPawn->GetComponentByClass(UCSHealthComponent::StaticClass()));
-
-            if (ensure(HealthComp) && !HealthComp->IsDead())
-            {
-                bReadyToEndMatch = false;
-                break;
-            }
-        }
+        bReadyToEndMatch = GetNumLivePlayers() == 0;
     }
 
     return bReadyToEndMatch;
@@ -106,6 +68,13 @@ void ACSWaveGameMode::SpawnBotTimerElapse()
 
     NumberOfBotsToSpawn--;
 
+    MarkRoundStateDirty();
+
     if (NumberOfBotsToSpawn <= 0)
         GetWorldTimerManager().ClearTimer(TimerHandle_BotSpawner);
+}
+
+APawn* ACSWaveGameMode::AcquireBot(const FTransform& SpawnTransform)
+{
+    return UCSActorPoolSubsystem::Acquire<APawn>(this, BotClass, SpawnTransform);
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSDamageSubsystem.h"
+#include "CSHealthComponent.h"
+
+#include "GameFramework/Actor.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CSDamageMergeTest
+{
+    const int32 NumCausers = 64;
+
+    /** Health component at full health, not owned by any actor */
+    UCSHealthComponent* MakeVictim()
+    {
+        UCSHealthComponent* HealthComp = NewObject<UCSHealthComponent>();
+        HealthComp->ResetHealth();
+
+        return HealthComp;
+    }
+
+    /** Queue a hit, returns its index */
+    int32 AddHit(TArray<FCSPendingDamage>& Hits, UCSHealthComponent* Victim, AActor* DamageCauser, float Damage)
+    {
+        FCSPendingDamage& Hit = Hits.AddDefaulted_GetRef();
+        Hit.Victim = Victim;
+        Hit.Damage = Damage;
+        Hit.DamageType = nullptr;
+        Hit.DamageCauser = DamageCauser;
+
+        return Hits.Num() - 1;
+    }
+
+    const FCSDamageContribution* FindContribution(const FCSDamageVictim& Victim, const AActor* DamageCauser)
+    {
+        return Victim.Contributions.FindByPredicate([DamageCauser](const FCSDamageContribution& Contribution)
+        {
+            return Contribution.DamageCauser.Get() == DamageCauser;
+        });
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSDamageMergeStressTest, "UE4Coop.Damage.MergeHits", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSDamageMergeStressTest::RunTest(const FString& Parameters)
+{
+    using namespace CSDamageMergeTest;
+
+    TArray<AActor*> Causers;
+    for (int32 Index = 0; Index < NumCausers; Index++)
+        Causers.Add(NewObject<AActor>());
+
+    // Focus is shot down by every causer, Sniped is killed by one causer before Focus dies, Survivor is hit first and lives
+    UCSHealthComponent* Focus = MakeVictim();
+    UCSHealthComponent* Sniped = MakeVictim();
+    UCSHealthComponent* Survivor = MakeVictim();
+
+    const float MaxHealth = Focus->GetHealth();
+    const float FocusDamage = 2.0f;
+    const float SnipeDamage = MaxHealth * 0.4f;
+
+    // Focus dies on the hit that takes its last health, hits are spread evenly so that is one of the first round
+    const int32 FocusKillerIndex = FMath::CeilToInt(MaxHealth / FocusDamage) - 1;
+    const AActor* FocusKiller = Causers[FocusKillerIndex];
+    const AActor* Sniper = Causers[NumCausers - 1];
+
+    TArray<FCSPendingDamage> Hits;
+    AddHit(Hits, Survivor, Causers[0], 5.0f);
+
+    int32 FocusKillHit = INDEX_NONE;
+    int32 SnipedKillHit = INDEX_NONE;
+    int32 NumSnipes = 0;
+
+    // Two rounds of fire, the second is all overkill
+    for (int32 Round = 0; Round < 2; Round++)
+    {
+        for (int32 Index = 0; Index < NumCausers; Index++)
+        {
+            const int32 HitIndex = AddHit(Hits, Focus, Causers[Index], FocusDamage);
+
+            if (Round == 0 && Index == FocusKillerIndex)
+                FocusKillHit = HitIndex;
+
+            if (Round == 0 && Index % 8 == 7)
+            {
+                const int32 SnipeIndex = AddHit(Hits, Sniped, Sniper, SnipeDamage);
+
+                if (++NumSnipes == 3)
+                    SnipedKillHit = SnipeIndex;
+            }
+        }
+    }
+
+    TArray<FCSDamageVictim> Victims;
+    TMap<UCSHealthComponent*, int32> VictimIndices;
+
+    UCSDamageSubsystem::MergeHits(Hits, Victims, VictimIndices);
+
+    if (!TestEqual(TEXT("One entry per victim"), Victims.Num(), 3))
+        return false;
+
+    // Deaths resolve in the order of their killing hit, survivors in the order of their first hit
+    TestTrue(TEXT("Survivor hit first comes first"), Victims[0].HealthComp == Survivor);
+    TestTrue(TEXT("Sniped victim killed before Focus comes next, though hit after it"), Victims[1].HealthComp == Sniped);
+    TestTrue(TEXT("Focus comes last"), Victims[2].HealthComp == Focus);
+
+    TestTrue(TEXT("Kill hits are in order"), SnipedKillHit < FocusKillHit);
+    TestEqual(TEXT("Sniped victim resolves at its killing hit"), Victims[1].HitIndex, SnipedKillHit);
+    TestEqual(TEXT("Focus resolves at its killing hit"), Victims[2].HitIndex, FocusKillHit);
+
+    const FCSDamageVictim& FocusVictim = Victims[2];
+
+    TestTrue(TEXT("Focus dies"), FocusVictim.Health <= 0.0f);
+    TestTrue(TEXT("Focus killer is the causer of the killing hit"), FocusVictim.DamageCauser.Get() == FocusKiller);
+    TestEqual(TEXT("Focus takes the damage up to the killing hit"), FocusVictim.Damage, (FocusKillerIndex + 1) * FocusDamage, 0.01f);
+    TestEqual(TEXT("Every causer up to the killer is credited"), FocusVictim.Contributions.Num(), FocusKillerIndex + 1);
+
+    float FocusContributions = 0.0f;
+    bool bEvenContributions = true;
+
+    for (int32 Index = 0; Index < NumCausers; Index++)
+    {
+        const FCSDamageContribution* Contribution = FindContribution(FocusVictim, Causers[Index]);
+
+        if (Index > FocusKillerIndex)
+        {
+            TestTrue(FString::Printf(TEXT("Causer %d firing after the kill is not credited"), Index), Contribution == nullptr);
+            continue;
+        }
+
+        if (!TestNotNull(FString::Printf(TEXT("Causer %d is credited"), Index), Contribution))
+            continue;
+
+        FocusContributions += Contribution->Damage;
+        bEvenContributions &= FMath::IsNearlyEqual(Contribution->Damage, FMath::Min(FocusDamage, MaxHealth - Index * FocusDamage), 0.01f);
+    }
+
+    TestTrue(TEXT("Each causer is credited the health its hit took"), bEvenContributions);
+    TestEqual(TEXT("Contributions add up to the health taken"), FocusContributions, MaxHealth - FocusVictim.Health, 0.01f);
+
+    const FCSDamageVictim& SnipedVictim = Victims[1];
+    const FCSDamageContribution* SniperContribution = FindContribution(SnipedVictim, Sniper);
+
+    TestTrue(TEXT("Sniped victim dies"), SnipedVictim.Health <= 0.0f);
+    TestTrue(TEXT("Sniper gets the kill"), SnipedVictim.DamageCauser.Get() == Sniper);
+    TestEqual(TEXT("Sniped victim ignores the overkill snipe"), SnipedVictim.Damage, 3 * SnipeDamage, 0.01f);
+
+    if (TestNotNull(TEXT("Sniper is credited"), SniperContribution))
+        TestEqual(TEXT("Sniper is credited the health taken"), SniperContribution->Damage, MaxHealth - SnipedVictim.Health, 0.01f);
+
+    const FCSDamageVictim& SurvivorVictim = Victims[0];
+
+    TestEqual(TEXT("Survivor keeps its health"), SurvivorVictim.Health, MaxHealth - 5.0f, 0.01f);
+    TestTrue(TEXT("Survivor is hit by its causer"), SurvivorVictim.DamageCauser.Get() == Causers[0]);
+    TestEqual(TEXT("Survivor has a single contribution"), SurvivorVictim.Contributions.Num(), 1);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSHitboxHistoryComponent.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CSHitboxHistoryTest
+{
+    const float HitboxRadius = 34.0f;
+    const float HitboxHalfHeight = 88.0f;
+
+    /** Height of the vulnerable bone above the hitbox center */
+    const float VulnerableHeight = 70.0f;
+
+    /** Snapshots are recorded every SnapshotInterval seconds from 0 to 1 */
+    const float SnapshotInterval = 0.1f;
+    const int32 NumSnapshots = 11;
+
+    /** The target runs along X at this speed */
+    const float TargetSpeed = 1000.0f;
+
+    FVector GetTargetLocation(float Time)
+    {
+        return FVector(1000.0f + TargetSpeed * Time, 0.0f, 0.0f);
+    }
+
+    /** History of an upright target moving along X, with its vulnerable bone above the center */
+    UCSHitboxHistoryComponent* MakeHistory()
+    {
+        UCSHitboxHistoryComponent* History = NewObject<UCSHitboxHistoryComponent>();
+        History->InitHistory(HitboxRadius, HitboxHalfHeight, true);
+
+        for (int32 Index = 0; Index < NumSnapshots; Index++)
+        {
+            FCSHitboxSnapshot Snapshot;
+            Snapshot.Time = Index * SnapshotInterval;
+            Snapshot.Location = GetTargetLocation(Snapshot.Time);
+            Snapshot.VulnerableLocation = Snapshot.Location + FVector(0.0f, 0.0f, VulnerableHeight);
+
+            History->AddSnapshot(Snapshot);
+        }
+
+        return History;
+    }
+
+    /** Shot along Y crossing the target's path at the given X and Z, claiming an impact on its front */
+    bool ConfirmShot(const UCSHitboxHistoryComponent* History, float Time, float X, float Z, bool& bOutVulnerable)
+    {
+        const FVector TraceStart(X, -1000.0f, Z);
+        const FVector TraceEnd(X, 1000.0f, Z);
+        const FVector ImpactPoint(X, -HitboxRadius, Z);
+
+        return History->ConfirmHit(Time, TraceStart, TraceEnd, ImpactPoint, bOutVulnerable);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSHitboxHistorySnapshotTest, "UE4Coop.HitboxHistory.GetSnapshotAtTime", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSHitboxHistorySnapshotTest::RunTest(const FString& Parameters)
+{
+    using namespace CSHitboxHistoryTest;
+
+    FCSHitboxSnapshot Snapshot;
+
+    UCSHitboxHistoryComponent* EmptyHistory = NewObject<UCSHitboxHistoryComponent>();
+    EmptyHistory->InitHistory(HitboxRadius, HitboxHalfHeight, true);
+
+    TestFalse(TEXT("Empty history has no snapshot"), EmptyHistory->GetSnapshotAtTime(0.5f, Snapshot));
+
+    UCSHitboxHistoryComponent* History = MakeHistory();
+
+    TestTrue(TEXT("Recorded time"), History->GetSnapshotAtTime(0.3f, Snapshot));
+    TestEqual(TEXT("Recorded time location"), Snapshot.Location, GetTargetLocation(0.3f), 0.1f);
+
+    TestTrue(TEXT("Time between snapshots"), History->GetSnapshotAtTime(0.35f, Snapshot));
+    TestEqual(TEXT("Time between snapshots is interpolated"), Snapshot.Location, GetTargetLocation(0.35f), 0.1f);
+    TestEqual(TEXT("Vulnerable bone is interpolated"), Snapshot.VulnerableLocation, GetTargetLocation(0.35f) + FVector(0.0f, 0.0f, VulnerableHeight), 0.1f);
+
+    TestTrue(TEXT("Future time"), History->GetSnapshotAtTime(5.0f, Snapshot));
+    TestEqual(TEXT("Future time uses the newest snapshot"), Snapshot.Location, GetTargetLocation(1.0f), 0.1f);
+
+    TestTrue(TEXT("Time before the history"), History->GetSnapshotAtTime(-1.0f, Snapshot));
+    TestEqual(TEXT("Time before the history uses the oldest snapshot"), Snapshot.Location, GetTargetLocation(0.0f), 0.1f);
+
+    // Keep recording long after the ring buffer is full, the oldest snapshots get overwritten
+    for (int32 Index = NumSnapshots; Index < 200; Index++)
+    {
+        FCSHitboxSnapshot NewSnapshot;
+        NewSnapshot.Time = Index * SnapshotInterval;
+        NewSnapshot.Location = GetTargetLocation(NewSnapshot.Time);
+
+        History->AddSnapshot(NewSnapshot);
+    }
+
+    TestTrue(TEXT("Wrapped history"), History->GetSnapshotAtTime(0.0f, Snapshot));
+    TestTrue(TEXT("Wrapped history forgot the first snapshots"), Snapshot.Time > 0.0f);
+
+    TestTrue(TEXT("Wrapped history newest"), History->GetSnapshotAtTime(199 * SnapshotInterval, Snapshot));
+    TestEqual(TEXT("Wrapped history keeps the newest snapshot"), Snapshot.Location, GetTargetLocation(199 * SnapshotInterval), 0.1f);
+
+    History->ClearHistory();
+
+    TestFalse(TEXT("Cleared history has no snapshot"), History->GetSnapshotAtTime(0.5f, Snapshot));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSHitboxHistoryConfirmHitTest, "UE4Coop.HitboxHistory.ConfirmHit", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSHitboxHistoryConfirmHitTest::RunTest(const FString& Parameters)
+{
+    using namespace CSHitboxHistoryTest;
+
+    UCSHitboxHistoryComponent* History = MakeHistory();
+
+    bool bVulnerable = false;
+
+    const float ShotTime = 0.25f;
+    const float ShotX = GetTargetLocation(ShotTime).X;
+
+    TestTrue(TEXT("Shot at the rewound target is accepted"), ConfirmShot(History, ShotTime, ShotX, 0.0f, bVulnerable));
+    TestFalse(TEXT("Shot at the chest is not vulnerable"), bVulnerable);
+
+    TestTrue(TEXT("Shot at the rewound head is accepted"), ConfirmShot(History, ShotTime, ShotX, VulnerableHeight, bVulnerable));
+    TestTrue(TEXT("Shot at the rewound head is vulnerable"), bVulnerable);
+
+    TestFalse(TEXT("Shot where the target was is rejected at a later time"), ConfirmShot(History, 0.75f, ShotX, 0.0f, bVulnerable));
+    TestFalse(TEXT("Rejected shot is not vulnerable"), bVulnerable);
+
+    TestFalse(TEXT("Shot above the target is rejected"), ConfirmShot(History, ShotTime, ShotX, HitboxHalfHeight + 100.0f, bVulnerable));
+
+    // Trace through the target but an impact point far from it
+    const FVector TraceStart(ShotX, -1000.0f, 0.0f);
+    const FVector TraceEnd(ShotX, 1000.0f, 0.0f);
+    TestFalse(TEXT("Impact away from the target is rejected"), History->ConfirmHit(ShotTime, TraceStart, TraceEnd, FVector(ShotX, -500.0f, 0.0f), bVulnerable));
+
+    // Impact point on the target but a trace that never gets near it
+    TestFalse(TEXT("Trace missing the target is rejected"), History->ConfirmHit(ShotTime, FVector(ShotX + 500.0f, -1000.0f, 0.0f), FVector(ShotX + 500.0f, 1000.0f, 0.0f), FVector(ShotX, -HitboxRadius, 0.0f), bVulnerable));
+
+    UCSHitboxHistoryComponent* BonelessHistory = NewObject<UCSHitboxHistoryComponent>();
+    BonelessHistory->InitHistory(HitboxRadius, HitboxHalfHeight, false);
+
+    FCSHitboxSnapshot Snapshot;
+    Snapshot.Location = GetTargetLocation(0.0f);
+    BonelessHistory->AddSnapshot(Snapshot);
+
+    TestTrue(TEXT("Shot at a target without vulnerable bone is accepted"), ConfirmShot(BonelessHistory, 0.0f, Snapshot.Location.X, VulnerableHeight, bVulnerable));
+    TestFalse(TEXT("Target without vulnerable bone is never hit vulnerable"), bVulnerable);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSHitboxHistoryAcceptRateTest, "UE4Coop.HitboxHistory.AcceptRate", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSHitboxHistoryAcceptRateTest::RunTest(const FString& Parameters)
+{
+    using namespace CSHitboxHistoryTest;
+
+    UCSHitboxHistoryComponent* History = MakeHistory();
+
+    // Shots within the hitbox radius always land, shots well past radius plus tolerance never do
+    const float MaxHitOffset = HitboxRadius;
+    const float MinMissOffset = 150.0f;
+
+    FRandomStream Stream(1234);
+
+    int32 NumHitShots = 0;
+    int32 NumAcceptedHits = 0;
+    int32 NumMissShots = 0;
+    int32 NumAcceptedMisses = 0;
+
+    for (int32 Index = 0; Index < 500; Index++)
+    {
+        const float Time = Stream.FRandRange(0.0f, 1.0f);
+        const float Z = Stream.FRandRange(-HitboxHalfHeight * 0.5f, HitboxHalfHeight * 0.5f);
+        const bool bAimAtTarget = Stream.FRand() < 0.5f;
+
+        const float Offset = bAimAtTarget ? Stream.FRandRange(-MaxHitOffset, MaxHitOffset) : Stream.FRandRange(MinMissOffset, 1000.0f) * (Stream.FRand() < 0.5f ? -1.0f : 1.0f);
+
+        bool bVulnerable = false;
+        const bool bAccepted = ConfirmShot(History, Time, GetTargetLocation(Time).X + Offset, Z, bVulnerable);
+
+        if (bAimAtTarget)
+        {
+            NumHitShots++;
+            NumAcceptedHits += bAccepted ? 1 : 0;
+        }
+        else
+        {
+            NumMissShots++;
+            NumAcceptedMisses += bAccepted ? 1 : 0;
+        }
+    }
+
+    TestEqual(TEXT("Every shot at the rewound target is accepted"), NumAcceptedHits, NumHitShots);
+    TestEqual(TEXT("No shot away from the rewound target is accepted"), NumAcceptedMisses, 0);
+    TestTrue(TEXT("Both kinds of shots were sampled"), NumHitShots > 0 && NumMissShots > 0);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
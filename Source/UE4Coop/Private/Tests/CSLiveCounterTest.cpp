@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSGameMode.h"
+#include "CSHealthComponent.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSLiveCounterOwnerTest, "UE4Coop.LiveCounter.Owner", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSLiveCounterOwnerTest::RunTest(const FString& Parameters)
+{
+    TestTrue(TEXT("Live bot"), UCSHealthComponent::GetLiveCounter(true, false, false) == ECSLiveCounter::Bot);
+    TestTrue(TEXT("Live player"), UCSHealthComponent::GetLiveCounter(true, true, false) == ECSLiveCounter::Player);
+    TestTrue(TEXT("Dead bot"), UCSHealthComponent::GetLiveCounter(true, false, true) == ECSLiveCounter::None);
+    TestTrue(TEXT("Dead player"), UCSHealthComponent::GetLiveCounter(true, true, true) == ECSLiveCounter::None);
+    TestTrue(TEXT("Not a pawn"), UCSHealthComponent::GetLiveCounter(false, false, false) == ECSLiveCounter::None);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSLiveCounterTransitionTest, "UE4Coop.LiveCounter.Transitions", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSLiveCounterTransitionTest::RunTest(const FString& Parameters)
+{
+    FCSLiveCounters Counters;
+
+    ECSLiveCounter Bot = ECSLiveCounter::None;
+    ECSLiveCounter Player = ECSLiveCounter::None;
+
+    // Player pawn spawns unpossessed, then gets possessed
+    TestTrue(TEXT("Spawned pawn is counted"), Counters.Update(Player, UCSHealthComponent::GetLiveCounter(true, false, false)));
+    TestEqual(TEXT("Unpossessed pawn counts as a bot"), Counters.NumBots, 1);
+
+    TestTrue(TEXT("Possessed pawn moves counter"), Counters.Update(Player, UCSHealthComponent::GetLiveCounter(true, true, false)));
+    TestEqual(TEXT("Possessed pawn is no bot"), Counters.NumBots, 0);
+    TestEqual(TEXT("Possessed pawn is a player"), Counters.NumPlayers, 1);
+
+    TestFalse(TEXT("Updating to the same counter does nothing"), Counters.Update(Player, ECSLiveCounter::Player));
+    TestEqual(TEXT("Player is not counted twice"), Counters.NumPlayers, 1);
+
+    // A bot spawns, dies, and its removal after death doesn't count again
+    TestTrue(TEXT("Bot spawns"), Counters.Update(Bot, UCSHealthComponent::GetLiveCounter(true, false, false)));
+    TestEqual(TEXT("Bot is counted"), Counters.NumBots, 1);
+
+    TestTrue(TEXT("Bot dies"), Counters.Update(Bot, UCSHealthComponent::GetLiveCounter(true, false, true)));
+    TestEqual(TEXT("Dead bot is not counted"), Counters.NumBots, 0);
+
+    TestFalse(TEXT("Dead bot removed"), Counters.Update(Bot, ECSLiveCounter::None));
+    TestEqual(TEXT("Removing a dead bot doesn't go negative"), Counters.NumBots, 0);
+
+    // The pooled bot comes back and is released again while alive
+    TestTrue(TEXT("Pooled bot reused"), Counters.Update(Bot, UCSHealthComponent::GetLiveCounter(true, false, false)));
+    TestEqual(TEXT("Reused bot is counted"), Counters.NumBots, 1);
+
+    TestTrue(TEXT("Live bot released to the pool"), Counters.Update(Bot, ECSLiveCounter::None));
+    TestFalse(TEXT("Bot released twice"), Counters.Update(Bot, ECSLiveCounter::None));
+    TestEqual(TEXT("Released bot is counted once"), Counters.NumBots, 0);
+
+    // Player dies, the round end check sees no live player, then it respawns
+    TestTrue(TEXT("Player dies"), Counters.Update(Player, UCSHealthComponent::GetLiveCounter(true, true, true)));
+    TestEqual(TEXT("No live player"), Counters.NumPlayers, 0);
+
+    TestTrue(TEXT("Player respawns"), Counters.Update(Player, UCSHealthComponent::GetLiveCounter(true, true, false)));
+    TestEqual(TEXT("Respawned player is counted"), Counters.NumPlayers, 1);
+
+    // Unpossessed while alive, e.g. the player left
+    TestTrue(TEXT("Player unpossessed"), Counters.Update(Player, UCSHealthComponent::GetLiveCounter(true, false, false)));
+    TestEqual(TEXT("Unpossessed pawn is no player"), Counters.NumPlayers, 0);
+    TestEqual(TEXT("Unpossessed pawn counts as a bot"), Counters.NumBots, 1);
+
+    TestTrue(TEXT("Pawn removed"), Counters.Update(Player, ECSLiveCounter::None));
+    TestEqual(TEXT("Every bot is gone"), Counters.NumBots, 0);
+    TestEqual(TEXT("Every player is gone"), Counters.NumPlayers, 0);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSLiveCounterWaveTest, "UE4Coop.LiveCounter.Wave", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSLiveCounterWaveTest::RunTest(const FString& Parameters)
+{
+    FCSLiveCounters Counters;
+
+    TArray<ECSLiveCounter> Bots;
+    Bots.Init(ECSLiveCounter::None, 20);
+
+    for (ECSLiveCounter& Bot : Bots)
+        Counters.Update(Bot, UCSHealthComponent::GetLiveCounter(true, false, false));
+
+    TestEqual(TEXT("Whole wave is counted"), Counters.NumBots, Bots.Num());
+
+    // Kill every bot, each is also removed when it goes back to the pool
+    for (int32 Index = 0; Index < Bots.Num(); Index++)
+    {
+        Counters.Update(Bots[Index], UCSHealthComponent::GetLiveCounter(true, false, true));
+        Counters.Update(Bots[Index], ECSLiveCounter::None);
+
+        TestEqual(TEXT("Live bots after a kill"), Counters.NumBots, Bots.Num() - Index - 1);
+    }
+
+    TestEqual(TEXT("The wave is over"), Counters.NumBots, 0);
+    TestEqual(TEXT("No player was counted"), Counters.NumPlayers, 0);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSProjectileWeapon.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSProjectileExplosionReconcileTest, "UE4Coop.Weapon.ProjectileExplosion.Reconcile", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSProjectileExplosionReconcileTest::RunTest(const FString& Parameters)
+{
+    using namespace CSProjectileExplosions;
+
+    const float MaxError = 100.0f;
+    const FVector ServerLocation(1000.0f, 500.0f, 0.0f);
+
+    // Shot 3 predicted close to the server, shot 4 far from it, shot 5 never exploded on the owner
+    TArray<FCSPredictedExplosion> Predicted;
+    Predicted.Add({ 2, ServerLocation + FVector(5000.0f, 0.0f, 0.0f) });
+    Predicted.Add({ 3, ServerLocation + FVector(0.0f, MaxError - 1.0f, 0.0f) });
+    Predicted.Add({ 4, ServerLocation + FVector(0.0f, 0.0f, MaxError + 1.0f) });
+
+    TestFalse(TEXT("Prediction within the error is kept"), ShouldPlayServerExplosion(false, Predicted, 3, ServerLocation, MaxError));
+    TestTrue(TEXT("Prediction outside the error is corrected"), ShouldPlayServerExplosion(false, Predicted, 4, ServerLocation, MaxError));
+    TestTrue(TEXT("Shot without prediction is played"), ShouldPlayServerExplosion(false, Predicted, 5, ServerLocation, MaxError));
+
+    // The server projectile hit something first, the owner's is removed and the server's explosion replaces it
+    TestTrue(TEXT("Projectile in flight is replaced by the server explosion"), ShouldPlayServerExplosion(true, Predicted, 5, ServerLocation, MaxError));
+    TestTrue(TEXT("In flight wins over a close prediction"), ShouldPlayServerExplosion(true, Predicted, 3, ServerLocation, MaxError));
+
+    TestTrue(TEXT("No predictions at all"), ShouldPlayServerExplosion(false, TArrayView<const FCSPredictedExplosion>(), 3, ServerLocation, MaxError));
+    TestFalse(TEXT("Exact prediction with no error allowed is kept"), ShouldPlayServerExplosion(false, Predicted, 3, Predicted[1].Location, 0.0f));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
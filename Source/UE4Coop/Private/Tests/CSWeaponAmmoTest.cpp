@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSWeapon.h"
+#include "CSWeaponStatsSubsystem.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CSWeaponAmmoTest
+{
+    const int32 AmmoPerClip = 5;
+    const int32 InitialClips = 3;
+
+    FCSWeaponStats MakeStats()
+    {
+        FCSWeaponStatsRow Row;
+        Row.AmmoPerClip = AmmoPerClip;
+        Row.InitialClips = InitialClips;
+
+        return FCSWeaponStats(Row);
+    }
+
+    FCSAmmoState MakeFullAmmo()
+    {
+        FCSAmmoState Ammo;
+        Ammo.AmmoInClip = AmmoPerClip;
+        Ammo.Ammo = AmmoPerClip * InitialClips;
+        Ammo.AmmoInMagazine = Ammo.Ammo - Ammo.AmmoInClip;
+
+        return Ammo;
+    }
+
+    void ApplyAction(FCSAmmoState& Ammo, bool bReload, const FCSWeaponStats& Stats)
+    {
+        if (bReload)
+            CSWeaponAmmo::ApplyReload(Ammo, Stats);
+        else
+            CSWeaponAmmo::UseAmmo(Ammo, Stats);
+    }
+
+    bool IsSameAmmo(const FCSAmmoState& A, const FCSAmmoState& B)
+    {
+        return A.Ammo == B.Ammo && A.AmmoInClip == B.AmmoInClip && A.AmmoInMagazine == B.AmmoInMagazine;
+    }
+
+    /** Server ammo state on its way to the owner */
+    struct FSentAmmoState
+    {
+        int32 ArrivalStep;
+
+        FCSAmmoState Ammo;
+    };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSWeaponAmmoLatencyTest, "UE4Coop.Weapon.Ammo.Latency", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSWeaponAmmoLatencyTest::RunTest(const FString& Parameters)
+{
+    using namespace CSWeaponAmmoTest;
+
+    const FCSWeaponStats Stats = MakeStats();
+
+    // Shots and reloads of the owner, one per step, emptying the clip twice
+    const bool Actions[] = { false, false, false, true, false, false, false, false, false, true, false, false };
+    const int32 NumActions = ARRAY_COUNT(Actions);
+
+    // Steps an action or an ammo state takes to get across, so an ack arrives a round trip after the action
+    const int32 Latencies[] = { 0, 1, 2, 4, 8 };
+
+    for (const int32 Latency : Latencies)
+    {
+        FCSAmmoState Owner = MakeFullAmmo();
+        FCSAmmoState Predicted = MakeFullAmmo();
+        FCSAmmoState Server = MakeFullAmmo();
+
+        TArray<FCSPredictedAmmoAction> PredictedActions;
+        TArray<FSentAmmoState> SentStates;
+
+        bool bOwnerMatchesPrediction = true;
+        bool bUnackedActionsKept = true;
+        int32 NumReceived = 0;
+
+        for (int32 Step = 0; Step <= NumActions + 2 * Latency; Step++)
+        {
+            if (Step < NumActions)
+            {
+                ApplyAction(Owner, Actions[Step], Stats);
+                ApplyAction(Predicted, Actions[Step], Stats);
+
+                PredictedActions.Emplace(Step, Actions[Step]);
+            }
+
+            // The server processes the action sent Latency steps ago and answers with its ammo
+            const int32 ServerAction = Step - Latency;
+
+            if (ServerAction >= 0 && ServerAction < NumActions)
+            {
+                ApplyAction(Server, Actions[ServerAction], Stats);
+
+                FSentAmmoState& Sent = SentStates.AddDefaulted_GetRef();
+                Sent.ArrivalStep = Step + Latency;
+                Sent.Ammo = Server;
+                Sent.Ammo.LastActionId = ServerAction;
+            }
+
+            for (const FSentAmmoState& Sent : SentStates)
+            {
+                if (Sent.ArrivalStep != Step)
+                    continue;
+
+                Owner = CSWeaponAmmo::ReconcileAmmo(Sent.Ammo, PredictedActions, Stats);
+
+                bOwnerMatchesPrediction &= IsSameAmmo(Owner, Predicted);
+                bUnackedActionsKept &= PredictedActions.Num() == FMath::Min(Step + 1, NumActions) - (Sent.Ammo.LastActionId + 1);
+
+                NumReceived++;
+            }
+        }
+
+        const FString Case = FString::Printf(TEXT("%d steps latency"), Latency);
+
+        TestEqual(FString::Printf(TEXT("Every action is acknowledged, %s"), *Case), NumReceived, NumActions);
+        TestTrue(FString::Printf(TEXT("Late server ammo doesn't undo correct predictions, %s"), *Case), bOwnerMatchesPrediction);
+        TestTrue(FString::Printf(TEXT("Only unacknowledged actions are replayed, %s"), *Case), bUnackedActionsKept);
+        TestEqual(FString::Printf(TEXT("Nothing left to replay, %s"), *Case), PredictedActions.Num(), 0);
+        TestTrue(FString::Printf(TEXT("Owner ends on the server ammo, %s"), *Case), IsSameAmmo(Owner, Server));
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSWeaponAmmoRefusedReloadTest, "UE4Coop.Weapon.Ammo.RefusedReload", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSWeaponAmmoRefusedReloadTest::RunTest(const FString& Parameters)
+{
+    using namespace CSWeaponAmmoTest;
+
+    const FCSWeaponStats Stats = MakeStats();
+
+    // The owner fires three shots, reloads and fires once more
+    FCSAmmoState Owner = MakeFullAmmo();
+    TArray<FCSPredictedAmmoAction> PredictedActions;
+
+    const bool Actions[] = { false, false, false, true, false };
+    const int32 NumActions = ARRAY_COUNT(Actions);
+
+    for (int32 Index = 0; Index < NumActions; Index++)
+    {
+        ApplyAction(Owner, Actions[Index], Stats);
+        PredictedActions.Emplace(Index, Actions[Index]);
+    }
+
+    TestEqual(TEXT("Owner predicts a full clip minus a shot"), Owner.AmmoInClip, AmmoPerClip - 1);
+
+    // The server fired the same shots but refused the reload, its state acknowledges the reload without it
+    FCSAmmoState Server = MakeFullAmmo();
+
+    for (int32 Index = 0; Index < 3; Index++)
+        CSWeaponAmmo::UseAmmo(Server, Stats);
+
+    Server.LastActionId = 3;
+
+    Owner = CSWeaponAmmo::ReconcileAmmo(Server, PredictedActions, Stats);
+
+    TestEqual(TEXT("The last shot is still waiting for its ack"), PredictedActions.Num(), 1);
+    TestEqual(TEXT("The refused reload is undone, the last shot replayed on the server clip"), Owner.AmmoInClip, AmmoPerClip - 4);
+    TestEqual(TEXT("The magazine keeps its ammo"), Owner.AmmoInMagazine, Server.AmmoInMagazine);
+
+    // The last shot reaches the server as well
+    CSWeaponAmmo::UseAmmo(Server, Stats);
+    Server.LastActionId = 4;
+
+    Owner = CSWeaponAmmo::ReconcileAmmo(Server, PredictedActions, Stats);
+
+    TestEqual(TEXT("Everything is acknowledged"), PredictedActions.Num(), 0);
+    TestTrue(TEXT("Owner ends on the server ammo"), IsSameAmmo(Owner, Server));
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSWeapon.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSWeaponFireGridFrameRateTest, "UE4Coop.Weapon.FireGrid.FrameRates", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSWeaponFireGridFrameRateTest::RunTest(const FString& Parameters)
+{
+    const float TimesBetweenShots[] = { 0.1f, 60.0f / 700.0f, 0.05f, 0.02f };
+    const float FrameRates[] = { 20.0f, 30.0f, 60.0f, 144.0f, 240.0f };
+
+    const int32 MaxShots = 4;
+
+    for (const float TimeBetweenShots : TimesBetweenShots)
+    {
+        // End half way between two shots so float drift can't move the last one across the end
+        const float Duration = 10.0f + TimeBetweenShots * 0.5f;
+        const int32 ExpectedShots = FMath::FloorToInt(Duration / TimeBetweenShots) + 1;
+
+        for (const float FrameRate : FrameRates)
+        {
+            const double DeltaTime = 1.0 / FrameRate;
+
+            // The trigger is pulled at time zero, the first shot is owed right away
+            float NextFireTime = 0.0f;
+            float LastShotTime = -TimeBetweenShots;
+
+            int32 NumShots = 0;
+            bool bShotsOnGrid = true;
+
+            for (int32 Frame = 0; ; Frame++)
+            {
+                const float Now = FMath::Min(static_cast<float>(Frame * DeltaTime), Duration);
+
+                const float FirstShotTime = NextFireTime;
+                const int32 FrameShots = CSWeaponFiring::AdvanceFireGrid(NextFireTime, Now, TimeBetweenShots, MaxShots);
+
+                for (int32 Index = 0; Index < FrameShots; Index++)
+                {
+                    const float ShotTime = FirstShotTime + Index * TimeBetweenShots;
+
+                    bShotsOnGrid &= FMath::IsNearlyEqual(ShotTime - LastShotTime, TimeBetweenShots, 1.e-3f) && ShotTime <= Now;
+
+                    LastShotTime = ShotTime;
+                }
+
+                NumShots += FrameShots;
+
+                if (Now >= Duration)
+                    break;
+            }
+
+            const FString Case = FString::Printf(TEXT("%.0f rpm at %.0f fps"), 60.0f / TimeBetweenShots, FrameRate);
+
+            TestEqual(FString::Printf(TEXT("Shot count, %s"), *Case), NumShots, ExpectedShots);
+            TestTrue(FString::Printf(TEXT("Shots stay on the fire rate grid, %s"), *Case), bShotsOnGrid);
+        }
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCSWeaponFireGridHitchTest, "UE4Coop.Weapon.FireGrid.Hitch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCSWeaponFireGridHitchTest::RunTest(const FString& Parameters)
+{
+    // Exact in binary so the expected times are too
+    const float TimeBetweenShots = 0.125f;
+
+    float NextFireTime = 0.0f;
+
+    TestEqual(TEXT("A one second hitch fires at most MaxShots"), CSWeaponFiring::AdvanceFireGrid(NextFireTime, 1.0f, TimeBetweenShots, 4), 4);
+    TestEqual(TEXT("The rest of the hitch is dropped, the next shot stays on the grid"), NextFireTime, 1.125f);
+
+    TestEqual(TEXT("No shot is owed before the next grid time"), CSWeaponFiring::AdvanceFireGrid(NextFireTime, 1.1f, TimeBetweenShots, 4), 0);
+    TestEqual(TEXT("Nothing owed leaves the grid alone"), NextFireTime, 1.125f);
+
+    TestEqual(TEXT("The shot is owed on the grid time"), CSWeaponFiring::AdvanceFireGrid(NextFireTime, 1.125f, TimeBetweenShots, 4), 1);
+    TestEqual(TEXT("The grid moves one shot on"), NextFireTime, 1.25f);
+
+    TestEqual(TEXT("Shots owed within MaxShots all fire"), CSWeaponFiring::AdvanceFireGrid(NextFireTime, 1.5f, TimeBetweenShots, 4), 3);
+    TestEqual(TEXT("The grid moves past every shot fired"), NextFireTime, 1.625f);
+
+    NextFireTime = 2.0f;
+
+    TestEqual(TEXT("No shot without a fire rate"), CSWeaponFiring::AdvanceFireGrid(NextFireTime, 3.0f, 0.0f, 4), 0);
+    TestEqual(TEXT("No fire rate leaves the grid alone"), NextFireTime, 2.0f);
+
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSProjectileSubsystem.h"
+#include "CSProjectileWeapon.h"
+#include "CSTypes.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "Particles/ParticleSystemComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Update"), STAT_ProjectileUpdate, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile Impacts"), STAT_ProjectileImpacts, STATGROUP_Coop);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectiles In Flight"), STAT_ProjectilesInFlight, STATGROUP_Coop);
+
+static int32 ProjectileParallelThreshold = 32;
+FAutoConsoleVariableRef CVARProjectileParallelThreshold(
+    TEXT("COOP.ProjectileParallelThreshold"),
+    ProjectileParallelThreshold,
+    TEXT("Minimum number of projectiles in flight before their sweeps run in parallel"),
+    ECVF_Default);
+
+/** Bouncing projectiles slower than this come to rest */
+static const float MinBounceSpeed = 50.0f;
+
+void UCSProjectileSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    SET_DWORD_STAT(STAT_ProjectilesInFlight, Projectiles.Num());
+
+    UWorld* World = GetTickableGameObjectWorld();
+    if (Projectiles.Num() == 0 || World == nullptr)
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_ProjectileUpdate);
+
+    const int32 NumProjectiles = Projectiles.Num();
+
+    EndLocations.SetNumUninitialized(NumProjectiles, false);
+    bDidHit.SetNumUninitialized(NumProjectiles, false);
+    Hits.SetNum(NumProjectiles, false);
+
+    // Scene queries only read the physics scene, so the batch can be split across worker threads
+    const bool bSingleThreaded = NumProjectiles < ProjectileParallelThreshold;
+
+    ParallelFor(NumProjectiles, [this, World, DeltaTime](int32 Index)
+    {
+        bDidHit[Index] = SweepProjectile(World, Projectiles[Index], DeltaTime, EndLocations[Index], Hits[Index]);
+    }, bSingleThreaded);
+
+    // Explosions remove projectiles, walk backwards so the swapped in ones are already done
+    for (int32 Index = NumProjectiles - 1; Index >= 0; --Index)
+    {
+        FCSProjectile& Projectile = Projectiles[Index];
+
+        if (ApplySweep(Projectile, DeltaTime, EndLocations[Index], Hits[Index], bDidHit[Index]))
+            Explode(Index, (bDidHit[Index] && Projectile.bExplodeOnImpact) ? &Hits[Index] : nullptr);
+    }
+}
+
+TStatId UCSProjectileSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UCSProjectileSubsystem::LaunchProjectile(const FCSProjectile& Projectile, float FastForwardTime)
+{
+    const int32 Index = Projectiles.Add(Projectile);
+
+    UWorld* World = GetTickableGameObjectWorld();
+    if (FastForwardTime <= 0.0f || World == nullptr)
+        return;
+
+    // Catch up with the time the shot spent on its way to us, in a single sweep
+    FVector EndLocation;
+    FHitResult Hit;
+    const bool bHit = SweepProjectile(World, Projectiles[Index], FastForwardTime, EndLocation, Hit);
+
+    FCSProjectile& Launched = Projectiles[Index];
+
+    if (ApplySweep(Launched, FastForwardTime, EndLocation, Hit, bHit))
+        Explode(Index, (bHit && Launched.bExplodeOnImpact) ? &Hit : nullptr);
+}
+
+bool UCSProjectileSubsystem::RemoveProjectile(const ACSProjectileWeapon* Weapon, int32 ShotId)
+{
+    const int32 Index = Projectiles.IndexOfByPredicate([Weapon, ShotId](const FCSProjectile& Projectile)
+    {
+        return !Projectile.bAuthoritative && Projectile.ShotId == ShotId && Projectile.Weapon.Get() == Weapon;
+    });
+
+    if (Index == INDEX_NONE)
+        return false;
+
+    UParticleSystemComponent* TrailEffect = Projectiles[Index].TrailEffect.Get();
+    if (TrailEffect)
+        TrailEffect->DeactivateSystem();
+
+    Projectiles.RemoveAtSwap(Index, 1, false);
+
+    return true;
+}
+
+int32 UCSProjectileSubsystem::GetNumProjectiles() const
+{
+    return Projectiles.Num();
+}
+
+void UCSProjectileSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    Projectiles.Reset();
+    EndLocations.Reset();
+    Hits.Reset();
+    bDidHit.Reset();
+}
+
+void UCSProjectileSubsystem::Explode(int32 Index, const FHitResult* Hit)
+{
+    INC_DWORD_STAT(STAT_ProjectileImpacts);
+
+    // The weapon may spawn new projectiles from its explosion, take ours out first.
+    // Only the copy is valid after that, the slot now holds the swapped in projectile
+    const FCSProjectile Projectile = Projectiles[Index];
+    Projectiles.RemoveAtSwap(Index, 1, false);
+
+    UParticleSystemComponent* TrailEffect = Projectile.TrailEffect.Get();
+    if (TrailEffect)
+        TrailEffect->DeactivateSystem();
+
+    ACSProjectileWeapon* Weapon = Projectile.Weapon.Get();
+    if (Weapon)
+        Weapon->OnProjectileExploded(Projectile, Projectile.Location, Hit);
+}
+
+bool UCSProjectileSubsystem::SweepProjectile(const UWorld* World, const FCSProjectile& Projectile, float DeltaTime, FVector& OutEndLocation, FHitResult& OutHit)
+{
+    const FVector Gravity(0.0f, 0.0f, Projectile.GravityZ);
+    OutEndLocation = Projectile.Location + (Projectile.Velocity * DeltaTime) + (Gravity * (0.5f * DeltaTime * DeltaTime));
+
+    return World->SweepSingleByChannel(OutHit, Projectile.Location, OutEndLocation, FQuat::Identity,
+        COLLISION_WEAPON, FCollisionShape::MakeSphere(Projectile.Radius), Projectile.QueryParams);
+}
+
+bool UCSProjectileSubsystem::ApplySweep(FCSProjectile& Projectile, float DeltaTime, const FVector& EndLocation, const FHitResult& Hit, bool bHit)
+{
+    Projectile.TimeLeft -= DeltaTime;
+
+    if (bHit)
+    {
+        if (Projectile.bExplodeOnImpact)
+        {
+            Projectile.Location = Hit.Location;
+            return true;
+        }
+
+        // Bounce off, keeping only part of the speed, and out of the surface so the next sweep doesn't start in it
+        Projectile.Location = Hit.Location + Hit.ImpactNormal;
+        Projectile.Velocity = Projectile.Velocity.MirrorByVector(Hit.ImpactNormal) * Projectile.Bounciness;
+
+        if (Projectile.Velocity.SizeSquared() < FMath::Square(MinBounceSpeed))
+        {
+            Projectile.Velocity = FVector::ZeroVector;
+            Projectile.GravityZ = 0.0f;
+        }
+    }
+    else
+    {
+        Projectile.Location = EndLocation;
+        Projectile.Velocity.Z += Projectile.GravityZ * DeltaTime;
+    }
+
+    if (Projectile.TimeLeft <= 0.0f)
+        return true;
+
+    UParticleSystemComponent* TrailEffect = Projectile.TrailEffect.Get();
+    if (TrailEffect)
+        TrailEffect->SetWorldLocation(Projectile.Location);
+
+    return false;
+}
@@ -2,23 +2,185 @@
 
 
 #include "CSProjectileWeapon.h"
+#include "CSCharacter.h"
+#include "CSProjectileSubsystem.h"
+#include "CSEffectPoolSubsystem.h"
 
-void ACSProjectileWeapon::Fire()
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerState.h"
+#include "Kismet/GameplayStatics.h"
+
+/** Predicted explosions remembered for reconciliation, older ones are already settled */
+static const int32 MaxPredictedExplosions = 8;
+
+ACSProjectileWeapon::ACSProjectileWeapon()
 {
-    AActor* MyOwner = GetOwner();
+    ProjectileSpeed = 2000.0f;
+    ProjectileGravityScale = 1.0f;
+    ProjectileRadius = 10.0f;
+    ProjectileLifeSpan = 5.0f;
+    bExplodeOnImpact = true;
+    ProjectileBounciness = 0.3f;
+    ExplosionRadius = 300.0f;
+    MaxProjectileFastForward = 0.125f;
+    MaxPredictedExplosionError = 100.0f;
 
-    if (MyOwner == nullptr)
+    ProjectileEffect = nullptr;
+    ExplosionEffect = nullptr;
+}
+
+void ACSProjectileWeapon::Fire()
+{
+    if (!MyPawn || !CanFire())
         return;
 
     FVector EyeLocation;
     FRotator EyeRotation;
+    MyPawn->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+    LaunchProjectile(EyeRotation, CurrentShotId, 0.0f);
+}
+
+bool ACSProjectileWeapon::ProcessShotInput(const FCSShotInput& ShotInput)
+{
+    const bool bFired = Super::ProcessShotInput(ShotInput);
+
+    // Aim where the owner was looking when it sent the input
+    if (bFired)
+        LaunchProjectile(LastFireInputView, ShotInput.ShotId, GetProjectileFastForward());
+
+    return bFired;
+}
+
+float ACSProjectileWeapon::GetProjectileFastForward() const
+{
+    // The owner's cosmetic projectile has been flying for about half its round trip when the input arrives
+    const APlayerState* ShooterState = MyPawn ? MyPawn->PlayerState : nullptr;
+    const float Latency = ShooterState ? ShooterState->ExactPing * 0.001f : 0.0f;
+
+    return FMath::Min(Latency * 0.5f, MaxProjectileFastForward);
+}
+
+void ACSProjectileWeapon::LaunchProjectile(const FRotator& AimRotation, int32 ShotId, float FastForwardTime)
+{
+    const FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
+    const FVector LaunchVelocity = AimRotation.Vector() * ProjectileSpeed;
+
+    SimulateProjectile(MuzzleLocation, LaunchVelocity, HasAuthority(), ShotId, FastForwardTime);
+
+    ACSWeapon::PlayFireEffects(MuzzleLocation, MuzzleLocation + LaunchVelocity, false, SurfaceType_Default);
+
+    if (HasAuthority())
+    {
+        if (MyPawn)
+            MyPawn->RegisterAction(ECharacterAction::ShotFire);
+
+        ShotEvents.AddShot(MuzzleLocation, MuzzleLocation + LaunchVelocity, false, SurfaceType_Default);
+    }
+}
+
+void ACSProjectileWeapon::SimulateProjectile(const FVector& Location, const FVector& Velocity, bool bAuthoritative, int32 ShotId, float FastForwardTime)
+{
+    UCSProjectileSubsystem* ProjectileSubsystem = UCSWorldSubsystem::Get<UCSProjectileSubsystem>(this);
+    if (!ProjectileSubsystem)
+        return;
+
+    FCSProjectile Projectile;
+    Projectile.Weapon = this;
+    Projectile.InstigatorPawn = MyPawn;
+    Projectile.InstigatorController = MyPawn ? MyPawn->GetController() : nullptr;
+    Projectile.Location = Location;
+    Projectile.Velocity = Velocity;
+    Projectile.GravityZ = GetWorld()->GetGravityZ() * ProjectileGravityScale;
+    Projectile.Radius = ProjectileRadius;
+    Projectile.TimeLeft = ProjectileLifeSpan;
+    Projectile.Bounciness = ProjectileBounciness;
+    Projectile.bExplodeOnImpact = bExplodeOnImpact;
+    Projectile.bAuthoritative = bAuthoritative;
+    Projectile.ShotId = ShotId;
 
-    MyOwner->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+    Projectile.QueryParams.AddIgnoredActor(this);
+    if (MyPawn)
+        Projectile.QueryParams.AddIgnoredActor(MyPawn);
 
-    FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
+    if (ProjectileEffect && GetNetMode() != NM_DedicatedServer)
+        Projectile.TrailEffect = UCSEffectPoolSubsystem::PlayEffectAtLocation(this, ProjectileEffect, Location, Velocity.Rotation());
+
+    ProjectileSubsystem->LaunchProjectile(Projectile, FastForwardTime);
+}
+
+void ACSProjectileWeapon::PlayFireEffects(const FVector& TraceStart, const FVector& TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType)
+{
+    Super::PlayFireEffects(TraceStart, TraceEnd, false, SurfaceType);
+
+    SimulateProjectile(TraceStart, TraceEnd - TraceStart, false);
+}
+
+void ACSProjectileWeapon::OnProjectileExploded(const FCSProjectile& Projectile, const FVector& Location, const FHitResult* Hit)
+{
+    if (ExplosionEffect)
+        UCSEffectPoolSubsystem::PlayEffectAtLocation(this, ExplosionEffect, Location);
+
+    if (Projectile.ShotId != INDEX_NONE && !Projectile.bAuthoritative)
+    {
+        if (PredictedExplosions.Num() >= MaxPredictedExplosions)
+            PredictedExplosions.RemoveAt(0, 1, false);
+
+        PredictedExplosions.Add({ Projectile.ShotId, Location });
+    }
+
+    if (!Projectile.bAuthoritative || !HasAuthority())
+        return;
+
+    if (Projectile.ShotId != INDEX_NONE && MyPawn && !MyPawn->IsLocallyControlled())
+        ClientProjectileExploded(Projectile.ShotId, Location);
+
+    const float Damage = GetStats().BaseDamage;
+    AController* InstigatorController = Projectile.InstigatorController.Get();
+
+    AActor* DamageCauser = Projectile.InstigatorPawn.Get();
+    if (DamageCauser == nullptr)
+        DamageCauser = this;
+
+    if (ExplosionRadius > 0.0f)
+    {
+        TArray<AActor*> IgnoreActors;
+        IgnoreActors.Add(this);
+
+        UGameplayStatics::ApplyRadialDamage(this, Damage, Location, ExplosionRadius, DamageType, IgnoreActors, DamageCauser, InstigatorController);
+    }
+    else if (Hit && Hit->GetActor())
+    {
+        const FVector ShotDirection = Projectile.Velocity.GetSafeNormal();
+
+        UGameplayStatics::ApplyPointDamage(Hit->GetActor(), Damage, ShotDirection, *Hit, InstigatorController, DamageCauser, DamageType);
+    }
+}
+
+void ACSProjectileWeapon::ClientProjectileExploded_Implementation(int32 ShotId, FVector_NetQuantize Location)
+{
+    UCSProjectileSubsystem* ProjectileSubsystem = UCSWorldSubsystem::Get<UCSProjectileSubsystem>(this);
+
+    // Still in flight, the server projectile hit something ours will miss
+    const bool bWasInFlight = ProjectileSubsystem && ProjectileSubsystem->RemoveProjectile(this, ShotId);
+
+    if (!CSProjectileExplosions::ShouldPlayServerExplosion(bWasInFlight, PredictedExplosions, ShotId, Location, MaxPredictedExplosionError))
+        return;
+
+    if (ExplosionEffect)
+        UCSEffectPoolSubsystem::PlayEffectAtLocation(this, ExplosionEffect, Location);
+}
+
+bool CSProjectileExplosions::ShouldPlayServerExplosion(bool bWasInFlight, TArrayView<const FCSPredictedExplosion> PredictedExplosions, int32 ShotId, const FVector& Location, float MaxError)
+{
+    if (bWasInFlight)
+        return true;
 
-    FActorSpawnParameters SpawnParams;
-    SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+    const FCSPredictedExplosion* Predicted = PredictedExplosions.FindByPredicate([ShotId](const FCSPredictedExplosion& Explosion)
+    {
+        return Explosion.ShotId == ShotId;
+    });
 
-    GetWorld()->SpawnActor<AActor>(ProjectileClass, MuzzleLocation, EyeRotation, SpawnParams);
-}
\ No newline at end of file
+    return Predicted == nullptr || FVector::DistSquared(Predicted->Location, Location) > FMath::Square(MaxError);
+}
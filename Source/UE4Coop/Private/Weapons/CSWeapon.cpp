@@ -6,7 +6,12 @@
 #include "CSTypes.h"
 #include "CSPlayerState.h"
 #include "CSHealthComponent.h"
+#include "CSHitboxHistoryComponent.h"
 #include "CSAIController.h"
+#include "CSWeaponSubsystem.h"
+#include "CSEffectPoolSubsystem.h"
+#include "CSWeaponStatsSubsystem.h"
+#include "CSReplicationGraph.h"
 
 #include "Animation/AnimSequence.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
@@ -14,10 +19,15 @@
 #include "Components\SkeletalMeshComponent.h"
 #include "Particles\ParticleSystemComponent.h"
 #include "Particles\ParticleSystem.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
 #include "DrawDebugHelpers.h"
 #include "TimerManager.h"
 #include "Net/UnrealNetwork.h"
 
+DECLARE_CYCLE_STAT(TEXT("Weapon Pellet Resolve"), STAT_WeaponPelletResolve, STATGROUP_Coop);
+
 static int32 DebugWeaponDrawing = 0;
 FAutoConsoleVariableRef CVARDebugWeaponDrawing (
     TEXT("COOP.DebugWeapons"), 
@@ -35,36 +45,96 @@ ACSWeapon::ACSWeapon()
 
     BaseDamage          = 20.0f;
     ShootConeAngle      = 2.0f;
+    PelletCount         = 1;
     VulnerableDamage    = BaseDamage * 2.5f;
 
+    MaxClaimStartDeviation  = 200.0f;
+    ClaimTimeSlack          = 0.1f;
+    MaxClaimAngleDeviation  = 10.0f;
+
+    RedundantFireInputs = 3;
+    MaxRedundantShots = 4;
+    FireInputResends = 0;
+    LastFireInputId = INDEX_NONE;
+    LastProcessedShotId = INDEX_NONE;
+    LastFireInputView = FRotator::ZeroRotator;
+    NextShotInputTime = 0.0f;
+    ShotInputTimeSlack = 0.1f;
+
+    MaxShotEvents = 16;
+
+    StatsIndex = INDEX_NONE;
+    StatsRegistry = nullptr;
+
     NetUpdateFrequency = 66.0f;
     MinNetUpdateFrequency = 33.0f;
 
     MyPawn = nullptr;
+    bPooled = false;
 
     bWantsToFire = false;
 
+    LastFireTime = 0.0f;
+    NextFireTime = 0.0f;
+    CurrentShotTime = 0.0f;
+    CurrentShotId = INDEX_NONE;
+    bFireScheduled = false;
+
+    bReloading = false;
+    bPendingReload = false;
+
+    NextAmmoActionId = 0;
+    ReloadActionId = INDEX_NONE;
+    LastAckedAmmoActionId = INDEX_NONE;
+    MaxPredictedAmmoActions = 64;
+
     SetReplicates(true);
 }
 
-void ACSWeapon::BeginPlay()
+void ACSWeapon::PostInitializeComponents()
 {
-	Super::BeginPlay();
-	
-    // Calculate the time between shots base on the formula 60 / WeaponRateOfFire
-    TimeBetweenShots = 60 / WeaponConfig.RateOfFire;
+    Super::PostInitializeComponents();
+
+    ShotEvents.Owner = this;
+
+    UGameInstance* GameInstance = GetGameInstance();
+    StatsRegistry = GameInstance ? GameInstance->GetSubsystem<UCSWeaponStatsSubsystem>() : nullptr;
+
+    if (StatsRegistry)
+        StatsIndex = StatsRegistry->FindOrAddWeaponStats(this);
+
+    ResetAmmo();
 }
 
-void ACSWeapon::PostInitializeComponents()
+//////////////////////////////////////////////////////////////////////////
+// Pooling
+
+void ACSWeapon::OnAcquiredFromPool_Implementation()
 {
-    Super::PostInitializeComponents();
+    // Before ResetAmmo, the ammo state it replicates must not acknowledge the last owner's actions
+    ResetShotCounters();
 
-    if (WeaponConfig.InitialClips)
-    {
-        CurrentAmmoInClip = WeaponConfig.AmmoPerClip;
-        CurrentAmmo = WeaponConfig.AmmoPerClip * WeaponConfig.InitialClips;
-        CurrentAmmoInMagazine = CurrentAmmo - CurrentAmmoInClip;
-    }
+    ResetAmmo();
+
+    LastFireTime = 0.0f;
+}
+
+void ACSWeapon::SetPooled(bool bNewPooled)
+{
+    bPooled = bNewPooled;
+    OnRep_Pooled();
+}
+
+void ACSWeapon::OnReleasedToPool_Implementation()
+{
+    OnUnEquip();
+
+    // Shots of the last owner must not be played again when the weapon wakes up
+    ShotEvents.Items.Reset();
+    ShotEvents.MarkArrayDirty();
+
+    PendingShotInputs.Reset();
+    RecentShotInputs.Reset();
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -72,36 +142,43 @@ void ACSWeapon::PostInitializeComponents()
 
 void ACSWeapon::StartFire()
 {
-    if (!HasAuthority())
-        ServerStartFire();
-
     if (!bWantsToFire)
     {
         bWantsToFire = true;
 
+        if (!HasAuthority())
+            QueueFireInput();
+
         DetermineWeaponState();
     }
 }
 
 void ACSWeapon::StopFire()
 {
-    if ((!HasAuthority()) && MyPawn && MyPawn->IsLocallyControlled())
-        ServerStopFire();
-
     if (bWantsToFire)
     {
         bWantsToFire = false;
 
+        if (!HasAuthority() && MyPawn && MyPawn->IsLocallyControlled())
+            QueueFireInput();
+
         DetermineWeaponState();
     }
 }
 
 void ACSWeapon::StartReload(bool bFromReplication /*= false*/)
 {
+    const bool bCanReload = bFromReplication || CanReload();
+
     if (!bFromReplication && !HasAuthority())
-        ServerStartReload();
+    {
+        // Reloads we predict are acknowledged once the server reloaded as well
+        ReloadActionId = (bCanReload && IsPredictingAmmo()) ? NextAmmoActionId++ : INDEX_NONE;
 
-    if (bFromReplication || CanReload())
+        ServerStartReload(ReloadActionId);
+    }
+
+    if (bCanReload)
     {
         bPendingReload = true;
 
@@ -110,11 +187,11 @@ void ACSWeapon::StartReload(bool bFromReplication /*= false*/)
         float AnimDuration = PlayAnimation(ReloadAnim, 1.0f);
 
         if (AnimDuration <= 0.0f)
-            AnimDuration = WeaponConfig.NoAnimReloadDuration;
+            AnimDuration = GetStats().NoAnimReloadDuration;
 
         GetWorldTimerManager().SetTimer(TimerHandle_StopReload, this, &ACSWeapon::StopReload, AnimDuration, false);
 
-        if (HasAuthority())
+        if (HasAuthority() || IsPredictingAmmo())
         {
             if (MyPawn)
                 MyPawn->SetAiming(false);
@@ -144,22 +221,26 @@ void ACSWeapon::StopReload()
 //////////////////////////////////////////////////////////////////////////
 // Input - server side
 
-void ACSWeapon::ServerStartFire_Implementation()
+void ACSWeapon::ServerStartReload_Implementation(int32 ActionId)
 {
-    StartFire();
-}
+    StartReload();
 
-bool ACSWeapon::ServerStartFire_Validate()
-{
-    return true;
-}
+    if (ActionId == INDEX_NONE)
+        return;
 
-void ACSWeapon::ServerStartReload_Implementation()
-{
-    StartReload();
+    if (bReloading)
+    {
+        // Acknowledged when the reload is done
+        ReloadActionId = ActionId;
+        return;
+    }
+
+    // We can't reload, undo the reload the owner predicted
+    LastAckedAmmoActionId = FMath::Max(LastAckedAmmoActionId, ActionId);
+    ReplicateAmmoState();
 }
 
-bool ACSWeapon::ServerStartReload_Validate()
+bool ACSWeapon::ServerStartReload_Validate(int32 ActionId)
 {
     return true;
 }
@@ -174,49 +255,130 @@ bool ACSWeapon::ServerStopReload_Validate()
     return true;
 }
 
-void ACSWeapon::ServerStopFire_Implementation()
+//////////////////////////////////////////////////////////////////////////
+// Reload && Ammo System
+
+void ACSWeapon::ReloadWeapon()
 {
-    StopFire();
+    ApplyReload();
+
+    if (IsPredictingAmmo())
+    {
+        if (ReloadActionId != INDEX_NONE)
+            AddPredictedAmmoAction(ReloadActionId, true);
+    }
+    else if (HasAuthority())
+    {
+        if (ReloadActionId != INDEX_NONE)
+            LastAckedAmmoActionId = FMath::Max(LastAckedAmmoActionId, ReloadActionId);
+
+        ReplicateAmmoState();
+    }
+
+    ReloadActionId = INDEX_NONE;
 }
 
-bool ACSWeapon::ServerStopFire_Validate()
+void ACSWeapon::ApplyReload()
 {
-    return true;
-}
+    FCSAmmoState Ammo = MakeAmmoState();
+    CSWeaponAmmo::ApplyReload(Ammo, GetStats());
 
-//////////////////////////////////////////////////////////////////////////
-// Reload && Ammo System
+    ApplyAmmoState(Ammo);
+}
 
-void ACSWeapon::ReloadWeapon()
+void CSWeaponAmmo::ApplyReload(FCSAmmoState& Ammo, const FCSWeaponStats& Stats)
 {
-    int32 ClipDelta = FMath::Min(WeaponConfig.AmmoPerClip - CurrentAmmoInClip, CurrentAmmo - CurrentAmmoInClip);
+    int32 ClipDelta = FMath::Min(Stats.AmmoPerClip - Ammo.AmmoInClip, Ammo.Ammo - Ammo.AmmoInClip);
 
-    if (HasInfiniteClip())
-        ClipDelta = WeaponConfig.AmmoPerClip - CurrentAmmoInClip;
+    if (Stats.bInfiniteClip)
+        ClipDelta = Stats.AmmoPerClip - Ammo.AmmoInClip;
 
     if (ClipDelta > 0)
-        CurrentAmmoInClip += ClipDelta;
+        Ammo.AmmoInClip += ClipDelta;
+
+    if (Stats.bInfiniteClip)
+        Ammo.Ammo = FMath::Max(Ammo.AmmoInClip, Ammo.Ammo);
+
+    if (!Stats.bInfiniteAmmo)
+        Ammo.AmmoInMagazine = FMath::Clamp(Ammo.AmmoInMagazine - ClipDelta, 0, Ammo.AmmoInMagazine);
+}
+
+void ACSWeapon::ResetAmmo()
+{
+    const FCSWeaponStats& Stats = GetStats();
 
-    if (HasInfiniteClip())
-        CurrentAmmo = FMath::Max(CurrentAmmoInClip, CurrentAmmo);
+    if (Stats.InitialClips)
+    {
+        CurrentAmmoInClip = Stats.AmmoPerClip;
+        CurrentAmmo = Stats.AmmoPerClip * Stats.InitialClips;
+        CurrentAmmoInMagazine = CurrentAmmo - CurrentAmmoInClip;
+    }
 
-    if (!HasInfiniteAmmo())
-        CurrentAmmoInMagazine = FMath::Clamp(CurrentAmmoInMagazine - ClipDelta, 0, CurrentAmmoInMagazine);
+    if (HasAuthority())
+        ReplicateAmmoState();
 }
 
 void ACSWeapon::UseAmmo()
 {
-    if (!HasInfiniteClip())
-        CurrentAmmoInClip--;
+    FCSAmmoState Ammo = MakeAmmoState();
+    CSWeaponAmmo::UseAmmo(Ammo, GetStats());
 
-    if (!HasInfiniteAmmo())
-        CurrentAmmo--;
+    ApplyAmmoState(Ammo);
 
     ACSAIController* BotAI = MyPawn ? Cast<ACSAIController>(MyPawn->GetController()) : nullptr;
     if (BotAI)
         BotAI->CheckAmmo(this);
 }
 
+void CSWeaponAmmo::UseAmmo(FCSAmmoState& Ammo, const FCSWeaponStats& Stats)
+{
+    if (!Stats.bInfiniteClip)
+        Ammo.AmmoInClip--;
+
+    if (!Stats.bInfiniteAmmo)
+        Ammo.Ammo--;
+}
+
+FCSAmmoState ACSWeapon::MakeAmmoState() const
+{
+    FCSAmmoState Ammo;
+    Ammo.Ammo = CurrentAmmo;
+    Ammo.AmmoInClip = CurrentAmmoInClip;
+    Ammo.AmmoInMagazine = CurrentAmmoInMagazine;
+
+    return Ammo;
+}
+
+void ACSWeapon::ApplyAmmoState(const FCSAmmoState& Ammo)
+{
+    CurrentAmmo = Ammo.Ammo;
+    CurrentAmmoInClip = Ammo.AmmoInClip;
+    CurrentAmmoInMagazine = Ammo.AmmoInMagazine;
+}
+
+bool ACSWeapon::IsPredictingAmmo() const
+{
+    return !HasAuthority() && MyPawn && MyPawn->IsLocallyControlled();
+}
+
+void ACSWeapon::AddPredictedAmmoAction(int32 ActionId, bool bReload)
+{
+    if (PredictedAmmoActions.Num() >= MaxPredictedAmmoActions)
+        PredictedAmmoActions.RemoveAt(0, 1, false);
+
+    PredictedAmmoActions.Emplace(ActionId, bReload);
+}
+
+void ACSWeapon::ReplicateAmmoState()
+{
+    AmmoState = MakeAmmoState();
+    AmmoState.LastActionId = LastAckedAmmoActionId;
+
+    // Corrections should reach the owner before it predicts much further
+    if (HasActorBegunPlay())
+        ForceNetUpdate();
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Animation
 
@@ -295,7 +457,7 @@ bool ACSWeapon::CanFire() const
 bool ACSWeapon::CanReload() const
 {
     bool bCanReload = (!MyPawn || MyPawn->CanReload());
-    bool bGotAmmo = (CurrentAmmoInClip < WeaponConfig.AmmoPerClip) && (CurrentAmmo - CurrentAmmoInClip > 0 || HasInfiniteAmmo());
+    bool bGotAmmo = (CurrentAmmoInClip < GetStats().AmmoPerClip) && (CurrentAmmo - CurrentAmmoInClip > 0 || HasInfiniteAmmo());
     bool bStateOKToReload = ((CurrentState == EWeaponState::Idle) || (CurrentState == EWeaponState::Firing));
     return (bCanReload && bGotAmmo && bStateOKToReload);
 }
@@ -305,8 +467,16 @@ bool ACSWeapon::CanReload() const
 
 void ACSWeapon::OnEquip(ACSCharacter* Character)
 {
+    UCSReplicationGraph::OnWeaponOwnerChanged(this, MyPawn, Character);
     SetOwner(Character);
 
+    // The new owner numbers its inputs and predicted actions from scratch
+    if (MyPawn != Character)
+    {
+        ResetShotCounters();
+        ReplicateAmmoState();
+    }
+
     AttachToComponent(
         Character->GetMesh(), 
         FAttachmentTransformRules::SnapToTargetNotIncludingScale, 
@@ -315,55 +485,519 @@ void ACSWeapon::OnEquip(ACSCharacter* Character)
     MyPawn = Character;
 }
 
+void ACSWeapon::OnUnEquip()
+{
+    if (bPendingReload)
+        StopAnimation(ReloadAnim);
+
+    bWantsToFire = false;
+    bPendingReload = false;
+    bReloading = false;
+    ReloadActionId = INDEX_NONE;
+
+    GetWorldTimerManager().ClearTimer(TimerHandle_StopReload);
+    GetWorldTimerManager().ClearTimer(TimerHandle_ReloadWeapon);
+
+    DetermineWeaponState();
+
+    DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+    UCSReplicationGraph::OnWeaponOwnerChanged(this, MyPawn, nullptr);
+    SetOwner(nullptr);
+
+    MyPawn = nullptr;
+}
+
 void ACSWeapon::OnFireStarted()
 {
-    float FirstDelay = FMath::Max(LastFireTime + TimeBetweenShots - GetWorld()->TimeSeconds, 0.0f);
+    UCSWeaponSubsystem* WeaponSubsystem = UCSWorldSubsystem::Get<UCSWeaponSubsystem>(this);
+    if (WeaponSubsystem == nullptr)
+        return;
+
+    // Respect the fire rate across quick release and press of the trigger
+    NextFireTime = FMath::Max(LastFireTime + GetStats().TimeBetweenShots, GetWorld()->GetTimeSeconds());
+    bFireScheduled = true;
 
-    GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &ACSWeapon::HandleFiring, TimeBetweenShots, true, FirstDelay);
+    WeaponSubsystem->StartFiring(this);
 }
 
 void ACSWeapon::OnFireFinished()
 {
-    GetWorldTimerManager().ClearTimer(TimerHandle_HandleFiring);
+    bFireScheduled = false;
 }
 
-void ACSWeapon::ServerHandleFiring_Implementation()
+void ACSWeapon::AdvanceFiring(float Now, int32 MaxShots)
 {
-    const bool bShouldUpdateAmmo = (CurrentAmmoInClip > 0 && CanFire());
+    const float TimeBetweenShots = GetStats().TimeBetweenShots;
+
+    // No fire rate set, fire once per frame
+    if (TimeBetweenShots <= 0.0f)
+    {
+        HandleFiring(Now);
+        return;
+    }
 
-    HandleFiring();
+    const float FirstShotTime = NextFireTime;
+    const int32 NumShots = CSWeaponFiring::AdvanceFireGrid(NextFireTime, Now, TimeBetweenShots, MaxShots);
+
+    // Firing can stop in between shots, e.g. when the clip runs out
+    for (int32 Index = 0; Index < NumShots && bFireScheduled; Index++)
+        HandleFiring(FirstShotTime + Index * TimeBetweenShots);
+}
+
+int32 CSWeaponFiring::AdvanceFireGrid(float& NextFireTime, float Now, float TimeBetweenShots, int32 MaxShots)
+{
+    if (TimeBetweenShots <= 0.0f)
+        return 0;
+
+    int32 NumShots = 0;
+
+    while (NextFireTime <= Now)
+    {
+        if (NumShots >= MaxShots)
+        {
+            // Drop the rest of a long hitch but stay on the fire rate grid
+            NextFireTime += (FMath::FloorToFloat((Now - NextFireTime) / TimeBetweenShots) + 1.0f) * TimeBetweenShots;
+            break;
+        }
+
+        NextFireTime += TimeBetweenShots;
+
+        NumShots++;
+    }
+
+    return NumShots;
+}
+
+void ACSWeapon::QueueFireInput()
+{
+    FireInputResends = RedundantFireInputs;
+
+    UCSWeaponSubsystem* WeaponSubsystem = UCSWorldSubsystem::Get<UCSWeaponSubsystem>(this);
+    if (WeaponSubsystem)
+        WeaponSubsystem->QueueFireInput(this);
+}
+
+void ACSWeapon::SendFireInput()
+{
+    if (HasAuthority())
+        return;
+
+    FCSFireInput Input;
+    Input.InputId = ++LastFireInputId;
+    Input.bWantsToFire = bWantsToFire;
+
+    if (MyPawn)
+    {
+        FVector EyeLocation;
+        FRotator EyeRotation;
+        MyPawn->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+        Input.ViewPitch = FRotator::CompressAxisToShort(EyeRotation.Pitch);
+        Input.ViewYaw = FRotator::CompressAxisToShort(EyeRotation.Yaw);
+    }
+
+    Input.Shots.Reserve(RecentShotInputs.Num() + PendingShotInputs.Num());
+    Input.Shots.Append(RecentShotInputs);
+    Input.Shots.Append(PendingShotInputs);
+
+    ServerFireInput(Input);
+
+    RecentShotInputs.Append(PendingShotInputs);
+    PendingShotInputs.Reset();
+
+    if (RecentShotInputs.Num() > MaxRedundantShots)
+        RecentShotInputs.RemoveAt(0, RecentShotInputs.Num() - MaxRedundantShots, false);
+
+    if (FireInputResends > 0)
+    {
+        FireInputResends--;
+
+        UCSWeaponSubsystem* WeaponSubsystem = UCSWorldSubsystem::Get<UCSWeaponSubsystem>(this);
+        if (WeaponSubsystem)
+            WeaponSubsystem->QueueFireInput(this);
+    }
+    else
+        RecentShotInputs.Reset();
+}
+
+bool ACSWeapon::ServerFireInput_Validate(const FCSFireInput& Input)
+{
+    // Only reject malformed data, limits depend on cvars and stats that may differ from the client's
+    for (const FCSShotInput& ShotInput : Input.Shots)
+    {
+        const FCSHitClaim& Claim = ShotInput.Claim;
+
+        if (Claim.TraceStart.ContainsNaN() || Claim.TraceEnd.ContainsNaN() || Claim.ImpactPoint.ContainsNaN())
+            return false;
+
+        for (const FCSHitClaim& PelletClaim : ShotInput.PelletClaims)
+        {
+            if (PelletClaim.TraceStart.ContainsNaN() || PelletClaim.TraceEnd.ContainsNaN() || PelletClaim.ImpactPoint.ContainsNaN())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void ACSWeapon::ServerFireInput_Implementation(const FCSFireInput& Input)
+{
+    // Unreliable inputs can arrive late or twice
+    if (Input.InputId <= LastFireInputId)
+        return;
+
+    LastFireInputId = Input.InputId;
+
+    LastFireInputView.Pitch = FRotator::DecompressAxisFromShort(Input.ViewPitch);
+    LastFireInputView.Yaw = FRotator::DecompressAxisFromShort(Input.ViewYaw);
+
+    // An input carries the shots of one frame and the redundant ones sent before, drop the oldest past that
+    const int32 MaxShots = MaxRedundantShots + UCSWeaponSubsystem::GetMaxShotsPerFrame();
+    const int32 FirstShot = FMath::Max(0, Input.Shots.Num() - MaxShots);
+
+    for (int32 Index = FirstShot; Index < Input.Shots.Num(); Index++)
+    {
+        const FCSShotInput& ShotInput = Input.Shots[Index];
+
+        if (ShotInput.ShotId <= LastProcessedShotId)
+            continue;
+
+        LastProcessedShotId = ShotInput.ShotId;
+
+        ProcessShotInput(ShotInput);
+    }
+
+    if (Input.bWantsToFire)
+        StartFire();
+    else
+        StopFire();
+}
+
+bool ACSWeapon::ProcessShotInput(const FCSShotInput& ShotInput)
+{
+    const bool bShouldUpdateAmmo = (CurrentAmmoInClip > 0 && CanFire()) && ConsumeShotInputTime();
 
     if (bShouldUpdateAmmo)
     {
         // Update ammo
         UseAmmo();
     }
+
+    LastAckedAmmoActionId = FMath::Max(LastAckedAmmoActionId, ShotInput.ShotId);
+
+    // Only answer when the owner got it wrong, its predicted ammo is right most of the time
+    if (CurrentAmmoInClip != ShotInput.PredictedAmmoInClip)
+        ReplicateAmmoState();
+
+    // Shots that didn't use a round can't hit anything
+    if (!bShouldUpdateAmmo)
+        return false;
+
+    if (ShotInput.bHasClaim)
+    {
+        if (GetStats().PelletCount > 1)
+            ProcessPelletClaims(ShotInput);
+        else
+            ProcessHitClaim(ShotInput.Claim);
+    }
+
+    return true;
 }
 
-bool ACSWeapon::ServerHandleFiring_Validate()
+bool ACSWeapon::ConsumeShotInputTime()
 {
+    const float TimeBetweenShots = GetStats().TimeBetweenShots;
+    const float Now = GetWorld()->GetTimeSeconds();
+
+    if (NextShotInputTime > Now + ShotInputTimeSlack)
+        return false;
+
+    // A late input doesn't earn a burst of shots, the slack only covers jitter
+    NextShotInputTime = FMath::Max(NextShotInputTime, Now - ShotInputTimeSlack) + TimeBetweenShots;
+
     return true;
 }
 
-bool ACSWeapon::ServerFire_Validate()
+void ACSWeapon::ProcessHitClaim(const FCSHitClaim& Claim)
+{
+    if (!MyPawn || !CanFire())
+        return;
+
+    const FVector ShotDirection = (Claim.TraceEnd - Claim.TraceStart).GetSafeNormal();
+
+    bool bVulnerable = false;
+
+    if (ConfirmHitClaim(Claim, bVulnerable))
+    {
+        const int32 NumVulnerableHits = bVulnerable ? 1 : 0;
+
+        ApplyHitDamage(MakeClaimHit(Claim), ShotDirection, GetHitDamage(1, NumVulnerableHits));
+    }
+
+    const FVector EffectsEnd = Claim.bDidHit ? FVector(Claim.ImpactPoint) : FVector(Claim.TraceEnd);
+
+    PlayFireEffects(Claim.TraceStart, EffectsEnd, Claim.bDidHit, Claim.SurfaceType);
+
+    MyPawn->RegisterAction(ECharacterAction::ShotFire);
+
+    ShotEvents.AddShot(Claim.TraceStart, EffectsEnd, Claim.bDidHit, Claim.SurfaceType);
+}
+
+void ACSWeapon::ProcessPelletClaims(const FCSShotInput& ShotInput)
+{
+    if (!MyPawn || !CanFire())
+        return;
+
+    const FCSHitClaim& Aim = ShotInput.Claim;
+
+    if (ConfirmClaimAim(Aim.TraceStart, Aim.TraceEnd))
+    {
+        // Claims only name the actors hit, the pellets are rebuilt from the seed and counted here
+        TArray<FVector> PelletDirections;
+        GetPelletDirections((Aim.TraceEnd - Aim.TraceStart).GetSafeNormal(), ShotInput.PelletSeed, PelletDirections);
+
+        const float WeaponRange = GetStats().WeaponRange;
+
+        TArray<FVector, TInlineAllocator<16>> PelletEnds;
+        PelletEnds.Reserve(PelletDirections.Num());
+
+        for (const FVector& Direction : PelletDirections)
+            PelletEnds.Add(Aim.TraceStart + (Direction * WeaponRange));
+
+        TBitArray<> PelletsLeft(true, PelletEnds.Num());
+
+        // Each pellet hits one actor at most, claims past the pellet count are dropped
+        const int32 NumClaims = FMath::Min(ShotInput.PelletClaims.Num(), PelletEnds.Num());
+
+        for (int32 Index = 0; Index < NumClaims; Index++)
+        {
+            const FCSHitClaim& Claim = ShotInput.PelletClaims[Index];
+
+            bool bVulnerable = false;
+
+            if (!ConfirmHitClaim(Claim, bVulnerable))
+                continue;
+
+            int32 NumVulnerablePellets = 0;
+            const int32 NumPellets = CountPelletHits(Claim, Aim.TraceStart, PelletEnds, PelletsLeft, NumVulnerablePellets);
+
+            if (NumPellets <= 0)
+                continue;
+
+            const FVector ShotDirection = (Claim.TraceEnd - Claim.TraceStart).GetSafeNormal();
+
+            ApplyHitDamage(MakeClaimHit(Claim), ShotDirection, GetHitDamage(NumPellets, NumVulnerablePellets));
+        }
+    }
+
+    PlayPelletEffects(Aim.TraceStart, Aim.TraceEnd, ShotInput.PelletSeed);
+
+    MyPawn->RegisterAction(ECharacterAction::ShotFire);
+
+    ShotEvents.AddShot(Aim.TraceStart, Aim.TraceEnd, false, SurfaceType_Default, ShotInput.PelletSeed);
+}
+
+bool ACSWeapon::ConfirmHitClaim(const FCSHitClaim& Claim, bool& bOutVulnerable) const
 {
+    bOutVulnerable = false;
+
+    if (!Claim.bDidHit || Claim.HitActor == nullptr || Claim.HitActor == MyPawn)
+        return false;
+
+    if (!ConfirmClaimAim(Claim.TraceStart, Claim.TraceEnd))
+        return false;
+
+    if (FVector::DistSquared(Claim.TraceStart, Claim.ImpactPoint) > FMath::Square(GetStats().WeaponRange + MaxClaimStartDeviation))
+        return false;
+
+    FCollisionQueryParams QueryParams;
+    QueryParams.AddIgnoredActor(MyPawn);
+    QueryParams.AddIgnoredActor(this);
+    QueryParams.bTraceComplex = true;
+
+    UCSHitboxHistoryComponent* HitboxHistory = Claim.HitActor->FindComponentByClass<UCSHitboxHistoryComponent>();
+
+    if (HitboxHistory)
+    {
+        const float RewindTime = GetClaimRewindTime(Claim, HitboxHistory);
+
+        bool bConfirmed = HitboxHistory->ConfirmHit(RewindTime, Claim.TraceStart, Claim.TraceEnd, Claim.ImpactPoint, bOutVulnerable);
+
+        // Level geometry doesn't move, nothing rewound can be behind a wall the server sees now
+        if (bConfirmed)
+        {
+            QueryParams.AddIgnoredActor(Claim.HitActor);
+
+            bConfirmed = !GetWorld()->LineTraceTestByObjectType(Claim.TraceStart, Claim.ImpactPoint, FCollisionObjectQueryParams(ECC_WorldStatic), QueryParams);
+        }
+
+        if (!bConfirmed)
+            bOutVulnerable = false;
+
+        if (DebugWeaponDrawing)
+            DrawDebugSphere(GetWorld(), Claim.ImpactPoint, 10.0f, 8, bConfirmed ? FColor::Green : FColor::Red, false, 1.0f, 0, 1.0f);
+
+        return bConfirmed;
+    }
+
+    // Targets without history don't move, a single trace along the claimed shot is enough
+    QueryParams.bReturnPhysicalMaterial = true;
+
+    FHitResult Hit;
+    if (!GetWorld()->LineTraceSingleByChannel(Hit, Claim.TraceStart, Claim.TraceEnd, COLLISION_WEAPON, QueryParams))
+        return false;
+
+    if (Hit.GetActor() != Claim.HitActor)
+        return false;
+
+    bOutVulnerable = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get()) == SURFACE_FLESHVULNERABLE;
+
     return true;
 }
 
-void ACSWeapon::ServerFire_Implementation()
+bool ACSWeapon::ConfirmClaimAim(const FVector& TraceStart, const FVector& TraceEnd) const
+{
+    // The shot has to start where the server thinks the shooter is looking from
+    FVector EyeLocation;
+    FRotator EyeRotation;
+    MyPawn->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+    if (FVector::DistSquared(EyeLocation, TraceStart) > FMath::Square(MaxClaimStartDeviation))
+        return false;
+
+    // ...and roughly where the server sees the shooter aim, not the view it sent along with the claim
+    const float MaxAngle = FMath::DegreesToRadians(GetStats().ShootConeAngle * 0.5f + MaxClaimAngleDeviation);
+    const FVector ClaimDirection = (TraceEnd - TraceStart).GetSafeNormal();
+
+    return (ClaimDirection | MyPawn->GetBaseAimRotation().Vector()) >= FMath::Cos(MaxAngle);
+}
+
+float ACSWeapon::GetClaimRewindTime(const FCSHitClaim& Claim, const UCSHitboxHistoryComponent* HitboxHistory) const
 {
-    Fire();
+    // Rewind only the claimed target, never further back than the shooter's latency allows
+    const float ServerTime = GetWorld()->GetTimeSeconds();
+
+    const APlayerState* ShooterState = MyPawn->PlayerState;
+    const float Latency = ShooterState ? ShooterState->ExactPing * 0.001f : 0.0f;
+    const float MaxRewind = FMath::Min(Latency + ClaimTimeSlack, HitboxHistory->GetMaxRewindTime());
+
+    return FMath::Clamp(Claim.ClientFireTime, ServerTime - MaxRewind, ServerTime);
 }
 
-void ACSWeapon::HandleFiring()
+int32 ACSWeapon::CountPelletHits(const FCSHitClaim& Claim, const FVector& TraceStart, TArrayView<const FVector> PelletEnds, TBitArray<>& PelletsLeft, int32& OutNumVulnerable) const
 {
+    OutNumVulnerable = 0;
+
+    UCSHitboxHistoryComponent* HitboxHistory = Claim.HitActor->FindComponentByClass<UCSHitboxHistoryComponent>();
+
+    FCSHitboxSnapshot Snapshot;
+    if (HitboxHistory && !HitboxHistory->GetSnapshotAtTime(GetClaimRewindTime(Claim, HitboxHistory), Snapshot))
+        return 0;
+
+    FCollisionQueryParams QueryParams;
+    QueryParams.AddIgnoredActor(MyPawn);
+    QueryParams.AddIgnoredActor(this);
+    QueryParams.bTraceComplex = true;
+    QueryParams.bReturnPhysicalMaterial = true;
+
+    int32 NumHits = 0;
+
+    // A pellet only counts once, against the first claimed target it passes through
+    for (int32 Index = 0; Index < PelletEnds.Num(); Index++)
+    {
+        if (!PelletsLeft[Index])
+            continue;
+
+        bool bDidHit = false;
+        bool bVulnerable = false;
+
+        if (HitboxHistory)
+            bDidHit = HitboxHistory->TraceHitbox(Snapshot, TraceStart, PelletEnds[Index], bVulnerable);
+        else
+        {
+            // Targets without history don't move, trace the pellet against the world as it is
+            FHitResult Hit;
+            bDidHit = GetWorld()->LineTraceSingleByChannel(Hit, TraceStart, PelletEnds[Index], COLLISION_WEAPON, QueryParams) && Hit.GetActor() == Claim.HitActor;
+            bVulnerable = bDidHit && UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get()) == SURFACE_FLESHVULNERABLE;
+        }
+
+        if (!bDidHit)
+            continue;
+
+        PelletsLeft[Index] = false;
+
+        NumHits++;
+
+        if (bVulnerable)
+            OutNumVulnerable++;
+    }
+
+    return NumHits;
+}
+
+FHitResult ACSWeapon::MakeClaimHit(const FCSHitClaim& Claim)
+{
+    const FVector ShotDirection = (Claim.TraceEnd - Claim.TraceStart).GetSafeNormal();
+
+    FHitResult Hit(Claim.HitActor, Cast<UPrimitiveComponent>(Claim.HitActor->GetRootComponent()), Claim.ImpactPoint, -ShotDirection);
+    Hit.TraceStart = Claim.TraceStart;
+    Hit.TraceEnd = Claim.TraceEnd;
+
+    return Hit;
+}
+
+float ACSWeapon::GetHitDamage(int32 NumHits, int32 NumVulnerableHits) const
+{
+    const FCSWeaponStats& Stats = GetStats();
+
+    return (NumHits - NumVulnerableHits) * Stats.BaseDamage + NumVulnerableHits * Stats.VulnerableDamage;
+}
+
+void ACSWeapon::ApplyHitDamage(const FHitResult& Hit, const FVector& ShotDirection, float Damage)
+{
+    AActor* HitActor = Hit.GetActor();
+
+    UGameplayStatics::ApplyPointDamage(HitActor, Damage, ShotDirection, Hit, MyPawn->Controller, MyPawn, DamageType);
+
+    // Hitting allies or neutral actors doesn't count towards the shooter's statistics
+    if (MyPawn && HitActor && HitActor != MyPawn && UCSHealthComponent::IsHostile(MyPawn, HitActor))
+    {
+        UCSHealthComponent* HealthComp = UCSHealthComponent::FindHealthComponent(HitActor);
+        // The killing shot and any overkill don't count as hits, also when the damage waits for the end of the frame
+        if (HealthComp && !HealthComp->IsDeadOrDoomed())
+            MyPawn->RegisterAction(ECharacterAction::ShotHit);
+    }
+}
+
+void ACSWeapon::HandleFiring(float ShotTime)
+{
+    CurrentShotTime = ShotTime;
+
     if ((CurrentAmmoInClip > 0 || HasInfiniteClip() || HasInfiniteAmmo()) && CanFire())
     {
         if (MyPawn && MyPawn->IsLocallyControlled())
         {
+            // The shot input is filled in by the trace and sent to the server at the end of the frame
+            const bool bPredicting = IsPredictingAmmo();
+            const int32 ShotInputIndex = bPredicting ? PendingShotInputs.AddDefaulted() : INDEX_NONE;
+
+            CurrentShotId = bPredicting ? NextAmmoActionId++ : INDEX_NONE;
+
+            if (bPredicting)
+                PendingShotInputs[ShotInputIndex].ShotId = CurrentShotId;
+
             Fire();
 
             UseAmmo();
+
+            if (bPredicting)
+            {
+                AddPredictedAmmoAction(CurrentShotId, false);
+
+                PendingShotInputs[ShotInputIndex].PredictedAmmoInClip = CurrentAmmoInClip;
+
+                QueueFireInput();
+            }
         }
     }
     else if (CanReload())
@@ -371,15 +1005,12 @@ void ACSWeapon::HandleFiring()
 
     if (MyPawn && MyPawn->IsLocallyControlled())
     {
-        if (MyPawn->Role < ENetRole::ROLE_Authority)
-            ServerHandleFiring();
-
         // Reload after firing last round
         if (CurrentAmmoInClip <= 0 && CanReload())
             StartReload();
     }
 
-    LastFireTime = GetWorld()->GetTimeSeconds();
+    LastFireTime = ShotTime;
 }
 
 void ACSWeapon::Fire()
@@ -387,18 +1018,31 @@ void ACSWeapon::Fire()
     if (!MyPawn || !CanFire())
         return;
 
-    if (Role < ROLE_Authority)
-        ServerFire();
-
     FVector EyeLocation;
     FRotator EyeRotation;
     MyPawn->GetActorEyesViewPoint(EyeLocation, EyeRotation);
 
     FVector ShotDirection = EyeRotation.Vector();
 
-    float HalfConeAngle = FMath::DegreesToRadians(ShootConeAngle * 0.5f);
-    ShotDirection = FMath::VRandCone(ShotDirection, HalfConeAngle, HalfConeAngle);
-    FVector TraceEnd = EyeLocation + (ShotDirection * WeaponConfig.WeaponRange);
+    // Pellets are spread around the aim when they are traced
+    const bool bFiresPellets = GetStats().PelletCount > 1;
+
+    if (!bFiresPellets)
+    {
+        float HalfConeAngle = FMath::DegreesToRadians(GetStats().ShootConeAngle * 0.5f);
+        ShotDirection = FMath::VRandCone(ShotDirection, HalfConeAngle, HalfConeAngle);
+    }
+
+    AGameStateBase* GameState = GetWorld()->GetGameState();
+
+    FCSWeaponShot Shot;
+    Shot.TraceStart = EyeLocation;
+    Shot.TraceEnd = EyeLocation + (ShotDirection * GetStats().WeaponRange);
+    Shot.ShotDirection = ShotDirection;
+    // Shots owed earlier in the frame are stamped with the time they were owed at, for lag compensation
+    const float ShotAge = FMath::Max(GetWorld()->GetTimeSeconds() - CurrentShotTime, 0.0f);
+    Shot.FireTime = (GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds()) - ShotAge;
+    Shot.ShotId = CurrentShotId;
 
     FCollisionQueryParams QueryParams;
 
@@ -408,48 +1052,247 @@ void ACSWeapon::Fire()
     QueryParams.bTraceComplex           = true;
     QueryParams.bReturnPhysicalMaterial = true;
 
+    if (bFiresPellets)
+    {
+        FirePellets(Shot, QueryParams);
+        return;
+    }
+
     if (DebugWeaponDrawing)
-        DrawDebugLine(GetWorld(), EyeLocation, TraceEnd, FColor::White, false, 1.0f, 0, 1.0f);
+        DrawDebugLine(GetWorld(), Shot.TraceStart, Shot.TraceEnd, FColor::White, false, 1.0f, 0, 1.0f);
+
+    // Resolve the trace together with every other shot of this frame
+    UCSWeaponSubsystem* WeaponSubsystem = UCSWorldSubsystem::Get<UCSWeaponSubsystem>(this);
+
+    if (WeaponSubsystem && UCSWeaponSubsystem::IsTraceBatchingEnabled())
+    {
+        WeaponSubsystem->QueueTrace(this, Shot, QueryParams);
+        return;
+    }
 
     FHitResult Hit;
 
-    // TODO: Do a better hit confirmation
-    bool bDidHit = GetWorld()->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, COLLISION_WEAPON, QueryParams);
+    bool bDidHit = GetWorld()->LineTraceSingleByChannel(Hit, Shot.TraceStart, Shot.TraceEnd, COLLISION_WEAPON, QueryParams);
 
-    EPhysicalSurface SurfaceType = EPhysicalSurface::SurfaceType_Default;
+    OnShotTraced(Shot, Hit, bDidHit);
+}
+
+void ACSWeapon::FirePellets(FCSWeaponShot& Shot, const FCollisionQueryParams& QueryParams)
+{
+    Shot.PelletSeed = static_cast<uint16>(FMath::Rand());
+
+    TArray<FVector> PelletDirections;
+    GetPelletDirections(Shot.ShotDirection, Shot.PelletSeed, PelletDirections);
 
-    if (bDidHit && MyPawn->HasAuthority())
+    const float WeaponRange = GetStats().WeaponRange;
+
+    TArray<FCSWeaponShot> PelletShots;
+    PelletShots.Reserve(PelletDirections.Num());
+
+    for (const FVector& Direction : PelletDirections)
     {
-        AActor* HitActor = Hit.GetActor();
+        FCSWeaponShot& Pellet = PelletShots.Add_GetRef(Shot);
+        Pellet.ShotDirection = Direction;
+        Pellet.TraceEnd = Shot.TraceStart + (Direction * WeaponRange);
 
-        SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+        if (DebugWeaponDrawing)
+            DrawDebugLine(GetWorld(), Pellet.TraceStart, Pellet.TraceEnd, FColor::White, false, 1.0f, 0, 1.0f);
+    }
+
+    UCSWeaponSubsystem* WeaponSubsystem = UCSWorldSubsystem::Get<UCSWeaponSubsystem>(this);
+
+    if (WeaponSubsystem && UCSWeaponSubsystem::IsTraceBatchingEnabled())
+    {
+        WeaponSubsystem->QueuePelletTraces(this, PelletShots, QueryParams);
+        return;
+    }
+
+    TArray<FCSWeaponTraceRequest> Pellets;
+    Pellets.SetNum(PelletShots.Num());
+
+    for (int32 Index = 0; Index < PelletShots.Num(); Index++)
+    {
+        FCSWeaponTraceRequest& Pellet = Pellets[Index];
+        Pellet.Shot = PelletShots[Index];
+        Pellet.bDidHit = GetWorld()->LineTraceSingleByChannel(Pellet.Hit, Pellet.Shot.TraceStart, Pellet.Shot.TraceEnd, COLLISION_WEAPON, QueryParams);
+    }
+
+    OnPelletsTraced(Pellets);
+}
 
-        float FinalDamage = SurfaceType == SURFACE_FLESHVULNERABLE ? VulnerableDamage : BaseDamage;
+void ACSWeapon::GetPelletDirections(const FVector& AimDirection, int32 PelletSeed, TArray<FVector>& OutDirections) const
+{
+    const FCSWeaponStats& Stats = GetStats();
+    const float HalfConeAngle = FMath::DegreesToRadians(Stats.ShootConeAngle * 0.5f);
 
-        UGameplayStatics::ApplyPointDamage(HitActor, FinalDamage, ShotDirection, Hit, MyPawn->Controller, MyPawn, DamageType);
+    // Seeded so remote clients rebuild the spread the shooter saw
+    FRandomStream Stream(PelletSeed);
 
-        if (MyPawn && HitActor && HitActor != MyPawn)
+    OutDirections.Reset(Stats.PelletCount);
+    OutDirections.Add(AimDirection);
+
+    for (int32 Index = 1; Index < Stats.PelletCount; Index++)
+        OutDirections.Add(Stream.VRandCone(AimDirection, HalfConeAngle, HalfConeAngle));
+}
+
+void ACSWeapon::OnShotTraced(const FCSWeaponShot& Shot, const FHitResult& Hit, bool bDidHit)
+{
+    // The weapon may have been dropped while the trace was queued
+    if (!MyPawn)
+        return;
+
+    EPhysicalSurface SurfaceType = EPhysicalSurface::SurfaceType_Default;
+
+    if (bDidHit)
+        SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+
+    if (Role < ROLE_Authority)
+    {
+        // Let the server confirm the hit against where the target was when we saw it
+        FCSHitClaim Claim;
+        Claim.TraceStart = Shot.TraceStart;
+        Claim.TraceEnd = Shot.TraceEnd;
+        Claim.ImpactPoint = bDidHit ? Hit.ImpactPoint : Shot.TraceEnd;
+        Claim.HitActor = bDidHit ? Hit.GetActor() : nullptr;
+        Claim.bDidHit = bDidHit;
+        Claim.SurfaceType = SurfaceType;
+        Claim.ClientFireTime = Shot.FireTime;
+
+        FCSShotInput* ShotInput = PendingShotInputs.FindByPredicate([&Shot](const FCSShotInput& Input)
         {
-            UCSHealthComponent* HealthComp = Cast<UCSHealthComponent>(HitActor->GetComponentByClass(UCSHealthComponent::StaticClass()));
-            if (HealthComp && !HealthComp->IsDead())
-                MyPawn->RegisterAction(ECharacterAction::ShotHit);
+            return Input.ShotId == Shot.ShotId;
+        });
+
+        if (ShotInput)
+        {
+            ShotInput->Claim = Claim;
+            ShotInput->bHasClaim = true;
         }
     }
+    else if (bDidHit)
+        ApplyHitDamage(Hit, Shot.ShotDirection, GetHitDamage(1, SurfaceType == SURFACE_FLESHVULNERABLE ? 1 : 0));
+
+    const FVector EffectsEnd = bDidHit ? Hit.ImpactPoint : Shot.TraceEnd;
 
-    PlayFireEffects(Hit, TraceEnd, bDidHit, SurfaceType);
+    PlayFireEffects(Shot.TraceStart, EffectsEnd, bDidHit, SurfaceType);
 
     if (Role == ROLE_Authority)
     {
-        if (MyPawn)
-            MyPawn->RegisterAction(ECharacterAction::ShotFire);
+        MyPawn->RegisterAction(ECharacterAction::ShotFire);
 
-        HitScanTrace.Hit = Hit;
-        HitScanTrace.TraceEnd = TraceEnd;
-        HitScanTrace.bDidHit = bDidHit;
-        HitScanTrace.ReplicationCount = HitScanTrace.ReplicationCount + 1;
+        ShotEvents.AddShot(Shot.TraceStart, EffectsEnd, bDidHit, SurfaceType);
     }
 }
 
+void ACSWeapon::OnPelletsTraced(TArrayView<const FCSWeaponTraceRequest> Pellets)
+{
+    // The weapon may have been dropped while the traces were queued
+    if (!MyPawn || Pellets.Num() == 0)
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_WeaponPelletResolve);
+
+    /** Pellets of the shot that hit the same actor */
+    struct FPelletVictim
+    {
+        AActor* Actor;
+        int32 FirstPellet;
+        int32 NumPellets;
+        int32 NumVulnerablePellets;
+        EPhysicalSurface SurfaceType;
+    };
+
+    TArray<FPelletVictim, TInlineAllocator<8>> Victims;
+
+    PlayMuzzleEffects();
+
+    for (int32 Index = 0; Index < Pellets.Num(); Index++)
+    {
+        const FCSWeaponTraceRequest& Pellet = Pellets[Index];
+
+        EPhysicalSurface SurfaceType = EPhysicalSurface::SurfaceType_Default;
+
+        if (Pellet.bDidHit)
+            SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Pellet.Hit.PhysMaterial.Get());
+
+        PlayImpactEffects(Pellet.Shot.TraceStart, Pellet.bDidHit ? Pellet.Hit.ImpactPoint : Pellet.Shot.TraceEnd, Pellet.bDidHit, SurfaceType);
+
+        AActor* HitActor = Pellet.bDidHit ? Pellet.Hit.GetActor() : nullptr;
+        if (HitActor == nullptr)
+            continue;
+
+        FPelletVictim* Victim = Victims.FindByPredicate([HitActor](const FPelletVictim& Other)
+        {
+            return Other.Actor == HitActor;
+        });
+
+        if (Victim == nullptr)
+        {
+            Victim = &Victims.AddDefaulted_GetRef();
+            Victim->Actor = HitActor;
+            Victim->FirstPellet = Index;
+            Victim->NumPellets = 0;
+            Victim->NumVulnerablePellets = 0;
+            Victim->SurfaceType = SurfaceType;
+        }
+
+        Victim->NumPellets++;
+
+        if (SurfaceType == SURFACE_FLESHVULNERABLE)
+            Victim->NumVulnerablePellets++;
+    }
+
+    // The first pellet flies along the aim
+    const FCSWeaponShot& AimShot = Pellets[0].Shot;
+
+    if (Role < ROLE_Authority)
+    {
+        FCSShotInput* ShotInput = PendingShotInputs.FindByPredicate([&AimShot](const FCSShotInput& Input)
+        {
+            return Input.ShotId == AimShot.ShotId;
+        });
+
+        if (ShotInput == nullptr)
+            return;
+
+        ShotInput->bHasClaim = true;
+        ShotInput->PelletSeed = AimShot.PelletSeed;
+
+        ShotInput->Claim.TraceStart = AimShot.TraceStart;
+        ShotInput->Claim.TraceEnd = AimShot.TraceEnd;
+        ShotInput->Claim.ImpactPoint = AimShot.TraceEnd;
+        ShotInput->Claim.ClientFireTime = AimShot.FireTime;
+
+        // One claim per actor hit instead of one per pellet
+        for (const FPelletVictim& Victim : Victims)
+        {
+            const FCSWeaponTraceRequest& Pellet = Pellets[Victim.FirstPellet];
+
+            FCSHitClaim& Claim = ShotInput->PelletClaims.AddDefaulted_GetRef();
+            Claim.TraceStart = Pellet.Shot.TraceStart;
+            Claim.TraceEnd = Pellet.Shot.TraceEnd;
+            Claim.ImpactPoint = Pellet.Hit.ImpactPoint;
+            Claim.HitActor = Victim.Actor;
+            Claim.bDidHit = true;
+            Claim.SurfaceType = Victim.SurfaceType;
+            Claim.ClientFireTime = Pellet.Shot.FireTime;
+        }
+
+        return;
+    }
+
+    for (const FPelletVictim& Victim : Victims)
+    {
+        const FCSWeaponTraceRequest& Pellet = Pellets[Victim.FirstPellet];
+
+        ApplyHitDamage(Pellet.Hit, Pellet.Shot.ShotDirection, GetHitDamage(Victim.NumPellets, Victim.NumVulnerablePellets));
+    }
+
+    MyPawn->RegisterAction(ECharacterAction::ShotFire);
+
+    ShotEvents.AddShot(AimShot.TraceStart, AimShot.TraceEnd, false, SurfaceType_Default, AimShot.PelletSeed);
+}
+
 void ACSWeapon::DetermineWeaponState()
 {
     EWeaponState NewState = EWeaponState::Idle;
@@ -480,20 +1323,53 @@ void ACSWeapon::SetWeaponState(EWeaponState NewState)
         OnFireStarted();
 }
 
-void ACSWeapon::PlayFireEffects(FHitResult Hit, FVector TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType)
+void ACSWeapon::PlayFireEffects(const FVector& TraceStart, const FVector& TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType)
 {
-    if (MuzzleEffect)
-        UGameplayStatics::SpawnEmitterAttached(MuzzleEffect, MeshComp, MuzzleSocketName);
+    PlayMuzzleEffects();
 
-    if (TracerEffect)
+    PlayImpactEffects(TraceStart, TraceEnd, bDidHit, SurfaceType);
+}
+
+void ACSWeapon::PlayPelletEffects(const FVector& TraceStart, const FVector& AimEnd, int32 PelletSeed)
+{
+    if (GetNetMode() == NM_DedicatedServer)
+        return;
+
+    TArray<FVector> PelletDirections;
+    GetPelletDirections((AimEnd - TraceStart).GetSafeNormal(), PelletSeed, PelletDirections);
+
+    FCollisionQueryParams QueryParams;
+    QueryParams.AddIgnoredActor(this);
+    QueryParams.bReturnPhysicalMaterial = true;
+
+    if (MyPawn)
+        QueryParams.AddIgnoredActor(MyPawn);
+
+    PlayMuzzleEffects();
+
+    const float WeaponRange = GetStats().WeaponRange;
+
+    // Cosmetic only, simple collision is close enough for the impacts
+    for (const FVector& Direction : PelletDirections)
     {
-        FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
+        const FVector TraceEnd = TraceStart + (Direction * WeaponRange);
 
-        UParticleSystemComponent* TracerComp = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), TracerEffect, MuzzleLocation);
+        FHitResult Hit;
+        const bool bDidHit = GetWorld()->LineTraceSingleByChannel(Hit, TraceStart, TraceEnd, COLLISION_WEAPON, QueryParams);
 
-        if (TracerComp)
-            TracerComp->SetVectorParameter("BeamEnd", bDidHit ? Hit.ImpactPoint : TraceEnd);
+        EPhysicalSurface SurfaceType = EPhysicalSurface::SurfaceType_Default;
+
+        if (bDidHit)
+            SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+
+        PlayImpactEffects(TraceStart, bDidHit ? Hit.ImpactPoint : TraceEnd, bDidHit, SurfaceType);
     }
+}
+
+void ACSWeapon::PlayMuzzleEffects()
+{
+    if (MuzzleEffect)
+        UCSEffectPoolSubsystem::PlayEffectAttached(MuzzleEffect, MeshComp, MuzzleSocketName);
 
     if (MyPawn)
     {
@@ -502,6 +1378,19 @@ void ACSWeapon::PlayFireEffects(FHitResult Hit, FVector TraceEnd, bool bDidHit,
         if (PlayerController)
             PlayerController->ClientPlayCameraShake(FireCamShake);
     }
+}
+
+void ACSWeapon::PlayImpactEffects(const FVector& TraceStart, const FVector& TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType)
+{
+    if (TracerEffect)
+    {
+        FVector MuzzleLocation = MeshComp->GetSocketLocation(MuzzleSocketName);
+
+        UParticleSystemComponent* TracerComp = UCSEffectPoolSubsystem::PlayEffectAtLocation(this, TracerEffect, MuzzleLocation);
+
+        if (TracerComp)
+            TracerComp->SetVectorParameter("BeamEnd", TraceEnd);
+    }
 
     if (!bDidHit)
         return;
@@ -520,7 +1409,7 @@ void ACSWeapon::PlayFireEffects(FHitResult Hit, FVector TraceEnd, bool bDidHit,
     }
 
     if (SelectedEffect)
-        UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), SelectedEffect, Hit.ImpactPoint, Hit.ImpactNormal.Rotation());
+        UCSEffectPoolSubsystem::PlayEffectAtLocation(this, SelectedEffect, TraceEnd, (TraceStart - TraceEnd).Rotation(), SurfaceType);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -528,12 +1417,12 @@ void ACSWeapon::PlayFireEffects(FHitResult Hit, FVector TraceEnd, bool bDidHit,
 
 bool ACSWeapon::HasInfiniteAmmo() const
 {
-    return WeaponConfig.bInfiniteAmmo;
+    return GetStats().bInfiniteAmmo;
 }
 
 bool ACSWeapon::HasInfiniteClip() const
 {
-    return WeaponConfig.bInfiniteClip;
+    return GetStats().bInfiniteClip;
 }
 
 bool ACSWeapon::IsReloading() const
@@ -553,7 +1442,7 @@ float ACSWeapon::GetReloadAnimationLength() const
 
 float ACSWeapon::GetWeaponRange() const
 {
-    return WeaponConfig.WeaponRange;
+    return GetStats().WeaponRange;
 }
 
 float ACSWeapon::GetCurrentAmmo() const
@@ -573,7 +1462,7 @@ float ACSWeapon::GetCurrentAmmoInMagazine() const
 
 float ACSWeapon::GetMaxAmmo() const
 {
-    return WeaponConfig.MaxAmmo;
+    return GetStats().MaxAmmo;
 }
 
 EWeaponState ACSWeapon::GetCurrentState() const
@@ -581,12 +1470,75 @@ EWeaponState ACSWeapon::GetCurrentState() const
     return CurrentState;
 }
 
+bool ACSWeapon::IsFireScheduled() const
+{
+    return bFireScheduled;
+}
+
+const FCSWeaponStats& ACSWeapon::GetStats() const
+{
+    return StatsRegistry ? StatsRegistry->GetStats(StatsIndex) : UCSWeaponStatsSubsystem::GetDefaultStats();
+}
+
+FCSWeaponStats ACSWeapon::GetBlueprintStats() const
+{
+    FCSWeaponStatsRow Row;
+    Row.bInfiniteAmmo = WeaponConfig.bInfiniteAmmo;
+    Row.bInfiniteClip = WeaponConfig.bInfiniteClip;
+    Row.MaxAmmo = WeaponConfig.MaxAmmo;
+    Row.AmmoPerClip = WeaponConfig.AmmoPerClip;
+    Row.InitialClips = WeaponConfig.InitialClips;
+    Row.NoAnimReloadDuration = WeaponConfig.NoAnimReloadDuration;
+    Row.WeaponRange = WeaponConfig.WeaponRange;
+    Row.RateOfFire = WeaponConfig.RateOfFire;
+    Row.BaseDamage = BaseDamage;
+    Row.VulnerableDamage = VulnerableDamage;
+    Row.ShootConeAngle = ShootConeAngle;
+    Row.PelletCount = PelletCount;
+
+    return FCSWeaponStats(Row);
+}
+
+FName ACSWeapon::GetStatsRowName() const
+{
+    return StatsRowName;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Replication
 
-void ACSWeapon::OnRep_HitScanTrace()
+void FCSShotEvent::PostReplicatedAdd(const FCSShotEventArray& InArraySerializer)
+{
+    ACSWeapon* Weapon = InArraySerializer.Owner;
+
+    // Shots received along with the weapon itself (join in progress, back in relevancy) are old news
+    if (Weapon == nullptr || Weapon->GetGameTimeSinceCreation() <= 0.0f)
+        return;
+
+    if (Weapon->GetStats().PelletCount > 1)
+        Weapon->PlayPelletEffects(TraceStart, TraceEnd, PelletSeed);
+    else
+        Weapon->PlayFireEffects(TraceStart, TraceEnd, bDidHit, SurfaceType);
+}
+
+void FCSShotEventArray::AddShot(const FVector& TraceStart, const FVector& TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType, uint16 PelletSeed)
 {
-    PlayFireEffects(HitScanTrace.Hit, HitScanTrace.TraceEnd, HitScanTrace.bDidHit, HitScanTrace.SurfaceType);
+    const int32 MaxItems = Owner ? Owner->MaxShotEvents : 1;
+
+    if (Items.Num() >= MaxItems)
+    {
+        Items.RemoveAt(0, Items.Num() - MaxItems + 1, false);
+        MarkArrayDirty();
+    }
+
+    FCSShotEvent& ShotEvent = Items.AddDefaulted_GetRef();
+    ShotEvent.TraceStart = TraceStart;
+    ShotEvent.TraceEnd = TraceEnd;
+    ShotEvent.bDidHit = bDidHit;
+    ShotEvent.SurfaceType = SurfaceType;
+    ShotEvent.PelletSeed = PelletSeed;
+
+    MarkItemDirty(ShotEvent);
 }
 
 void ACSWeapon::OnRep_Reload()
@@ -597,20 +1549,71 @@ void ACSWeapon::OnRep_Reload()
         StopReload();
 }
 
+void ACSWeapon::OnRep_AmmoState()
+{
+    ApplyAmmoState(CSWeaponAmmo::ReconcileAmmo(AmmoState, PredictedAmmoActions, GetStats()));
+}
+
+FCSAmmoState CSWeaponAmmo::ReconcileAmmo(const FCSAmmoState& ServerAmmo, TArray<FCSPredictedAmmoAction>& PredictedActions, const FCSWeaponStats& Stats)
+{
+    // Everything up to LastActionId is already part of the server ammo
+    const int32 NumAcked = PredictedActions.IndexByPredicate([&ServerAmmo](const FCSPredictedAmmoAction& Action)
+    {
+        return Action.ActionId > ServerAmmo.LastActionId;
+    });
+
+    PredictedActions.RemoveAt(0, NumAcked == INDEX_NONE ? PredictedActions.Num() : NumAcked, false);
+
+    FCSAmmoState Ammo = ServerAmmo;
+
+    for (const FCSPredictedAmmoAction& Action : PredictedActions)
+    {
+        if (Action.bReload)
+            ApplyReload(Ammo, Stats);
+        else
+            UseAmmo(Ammo, Stats);
+    }
+
+    return Ammo;
+}
+
+void ACSWeapon::OnRep_MyPawn()
+{
+    ResetShotCounters();
+}
+
+void ACSWeapon::OnRep_Pooled()
+{
+    SetActorEnableCollision(!bPooled);
+}
+
+void ACSWeapon::ResetShotCounters()
+{
+    PendingShotInputs.Reset();
+    RecentShotInputs.Reset();
+    FireInputResends = 0;
+    LastFireInputId = INDEX_NONE;
+    LastProcessedShotId = INDEX_NONE;
+    NextShotInputTime = 0.0f;
+
+    NextAmmoActionId = 0;
+    ReloadActionId = INDEX_NONE;
+    LastAckedAmmoActionId = INDEX_NONE;
+    PredictedAmmoActions.Reset();
+}
+
 void ACSWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
     Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
     // Replicate to everyone
     DOREPLIFETIME(ACSWeapon, MyPawn);
+    DOREPLIFETIME(ACSWeapon, bPooled);
 
     // Replicate to local owner only
-    DOREPLIFETIME_CONDITION(ACSWeapon, bReloading, COND_OwnerOnly);
-    DOREPLIFETIME_CONDITION(ACSWeapon, CurrentAmmo, COND_OwnerOnly);
-    DOREPLIFETIME_CONDITION(ACSWeapon, CurrentAmmoInClip, COND_OwnerOnly);
-    DOREPLIFETIME_CONDITION(ACSWeapon, CurrentAmmoInMagazine, COND_OwnerOnly);
+    DOREPLIFETIME_CONDITION(ACSWeapon, AmmoState, COND_OwnerOnly);
 
     // Replicate to everyone except the local owner
-    DOREPLIFETIME_CONDITION(ACSWeapon, HitScanTrace, COND_SkipOwner);
+    DOREPLIFETIME_CONDITION(ACSWeapon, ShotEvents, COND_SkipOwner);
     DOREPLIFETIME_CONDITION(ACSWeapon, bPendingReload, COND_SkipOwner);
 }
\ No newline at end of file
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSWeaponStatsSubsystem.h"
+#include "CSWeapon.h"
+#include "CSGameState.h"
+#include "CSTypes.h"
+
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("Weapon Stats Load"), STAT_WeaponStatsLoad, STATGROUP_Coop);
+
+static FAutoConsoleCommandWithWorldAndArgs CVARReloadWeaponStats(
+    TEXT("COOP.ReloadWeaponStats"),
+    TEXT("Reload weapon stats from a CSV file on the server, defaults to Saved/WeaponStats.csv. Clients receive the reloaded rows"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+    {
+        // Clients would fire with stats the server doesn't know about
+        if (World && World->GetNetMode() == NM_Client)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("COOP.ReloadWeaponStats has to run on the server"));
+            return;
+        }
+
+        UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+        UCSWeaponStatsSubsystem* WeaponStats = GameInstance ? GameInstance->GetSubsystem<UCSWeaponStatsSubsystem>() : nullptr;
+
+        if (WeaponStats)
+            WeaponStats->ReloadFromCSV(Args.Num() > 0 ? Args[0] : FPaths::ProjectSavedDir() / TEXT("WeaponStats.csv"), World);
+    }),
+    ECVF_Cheat);
+
+FCSWeaponStats::FCSWeaponStats()
+    : FCSWeaponStats(FCSWeaponStatsRow())
+{
+}
+
+FCSWeaponStats::FCSWeaponStats(const FCSWeaponStatsRow& Row)
+{
+    BaseDamage = Row.BaseDamage;
+    VulnerableDamage = Row.VulnerableDamage;
+    ShootConeAngle = Row.ShootConeAngle;
+    WeaponRange = Row.WeaponRange;
+    TimeBetweenShots = Row.RateOfFire > 0.0f ? 60.0f / Row.RateOfFire : 0.0f;
+    NoAnimReloadDuration = Row.NoAnimReloadDuration;
+    MaxAmmo = Row.MaxAmmo;
+    AmmoPerClip = Row.AmmoPerClip;
+    InitialClips = Row.InitialClips;
+    PelletCount = FMath::Clamp(Row.PelletCount, 1, 255);
+    bInfiniteAmmo = Row.bInfiniteAmmo;
+    bInfiniteClip = Row.bInfiniteClip;
+}
+
+void UCSWeaponStatsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    if (WeaponStatsTable.IsNull())
+        return;
+
+    const UDataTable* Table = Cast<UDataTable>(WeaponStatsTable.TryLoad());
+
+    if (Table)
+        LoadTable(Table);
+    else
+        UE_LOG(LogTemp, Warning, TEXT("Weapon stats table %s could not be loaded"), *WeaponStatsTable.ToString());
+}
+
+void UCSWeaponStatsSubsystem::LoadTable(const UDataTable* Table)
+{
+    SCOPE_CYCLE_COUNTER(STAT_WeaponStatsLoad);
+
+    if (Table->GetRowStruct() == nullptr || !Table->GetRowStruct()->IsChildOf(FCSWeaponStatsRow::StaticStruct()))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Weapon stats table %s doesn't use FCSWeaponStatsRow"), *Table->GetName());
+        return;
+    }
+
+    const TMap<FName, uint8*>& RowMap = Table->GetRowMap();
+
+    Stats.Reserve(Stats.Num() + RowMap.Num());
+
+    for (const TPair<FName, uint8*>& Row : RowMap)
+        LoadRow(Row.Key, *reinterpret_cast<const FCSWeaponStatsRow*>(Row.Value));
+}
+
+void UCSWeaponStatsSubsystem::LoadRow(FName RowName, const FCSWeaponStatsRow& Row)
+{
+    const FCSWeaponStats RowStats(Row);
+
+    const int32* StatsIndex = RowIndices.Find(RowName);
+
+    if (StatsIndex)
+        Stats[*StatsIndex] = RowStats;
+    else
+        RowIndices.Add(RowName, Stats.Add(RowStats));
+}
+
+void UCSWeaponStatsSubsystem::LoadOverrides(const TArray<FCSWeaponStatsOverride>& Overrides)
+{
+    for (const FCSWeaponStatsOverride& Override : Overrides)
+        LoadRow(Override.RowName, Override.Row);
+}
+
+int32 UCSWeaponStatsSubsystem::FindOrAddWeaponStats(const ACSWeapon* Weapon)
+{
+    const int32* RowIndex = RowIndices.Find(Weapon->GetStatsRowName());
+
+    if (RowIndex)
+        return *RowIndex;
+
+    UClass* WeaponClass = Weapon->GetClass();
+
+    const int32* ClassIndex = ClassIndices.Find(WeaponClass);
+
+    if (ClassIndex)
+        return *ClassIndex;
+
+    // Stats set on the Blueprint are the same for every instance, read them from the class defaults
+    const ACSWeapon* WeaponDefaults = WeaponClass->GetDefaultObject<ACSWeapon>();
+
+    return ClassIndices.Add(WeaponClass, Stats.Add(WeaponDefaults->GetBlueprintStats()));
+}
+
+const FCSWeaponStats& UCSWeaponStatsSubsystem::GetStats(int32 StatsIndex) const
+{
+    return Stats.IsValidIndex(StatsIndex) ? Stats[StatsIndex] : GetDefaultStats();
+}
+
+const FCSWeaponStats& UCSWeaponStatsSubsystem::GetDefaultStats()
+{
+    static const FCSWeaponStats DefaultStats;
+
+    return DefaultStats;
+}
+
+bool UCSWeaponStatsSubsystem::ReloadFromCSV(const FString& FilePath, UWorld* World)
+{
+    FString CSV;
+
+    if (!FFileHelper::LoadFileToString(CSV, *FilePath))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Weapon stats file %s could not be read"), *FilePath);
+        return false;
+    }
+
+    UDataTable* Table = NewObject<UDataTable>(GetTransientPackage());
+    Table->RowStruct = FCSWeaponStatsRow::StaticStruct();
+
+    const TArray<FString> Problems = Table->CreateTableFromCSVString(CSV);
+
+    for (const FString& Problem : Problems)
+        UE_LOG(LogTemp, Warning, TEXT("Weapon stats file %s: %s"), *FilePath, *Problem);
+
+    LoadTable(Table);
+
+    ACSGameState* CSGameState = World ? World->GetGameState<ACSGameState>() : nullptr;
+
+    if (CSGameState)
+    {
+        TArray<FCSWeaponStatsOverride> Overrides;
+        Overrides.Reserve(Table->GetRowMap().Num());
+
+        for (const TPair<FName, uint8*>& Row : Table->GetRowMap())
+        {
+            FCSWeaponStatsOverride& Override = Overrides.AddDefaulted_GetRef();
+            Override.RowName = Row.Key;
+            Override.Row = *reinterpret_cast<const FCSWeaponStatsRow*>(Row.Value);
+        }
+
+        CSGameState->AddWeaponStatsOverrides(Overrides);
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("Reloaded %d weapon stats rows from %s"), Table->GetRowMap().Num(), *FilePath);
+
+    return true;
+}
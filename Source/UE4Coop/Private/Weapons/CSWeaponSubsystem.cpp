@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CSWeaponSubsystem.h"
+#include "CSTypes.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Weapon Trace Batch"), STAT_WeaponTraceBatch, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon Traces"), STAT_WeaponTraces, STATGROUP_Coop);
+DECLARE_CYCLE_STAT(TEXT("Weapon Fire Advance"), STAT_WeaponFireAdvance, STATGROUP_Coop);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Weapon Fire Inputs"), STAT_WeaponFireInputs, STATGROUP_Coop);
+
+static int32 BatchWeaponTraces = 1;
+FAutoConsoleVariableRef CVARBatchWeaponTraces(
+    TEXT("COOP.BatchWeaponTraces"),
+    BatchWeaponTraces,
+    TEXT("Resolve all weapon traces of a frame in one batch instead of one by one"),
+    ECVF_Default);
+
+static int32 WeaponTraceParallelThreshold = 8;
+FAutoConsoleVariableRef CVARWeaponTraceParallelThreshold(
+    TEXT("COOP.WeaponTraceParallelThreshold"),
+    WeaponTraceParallelThreshold,
+    TEXT("Minimum number of queued weapon traces before the batch runs in parallel"),
+    ECVF_Default);
+
+static int32 MaxWeaponShotsPerFrame = 8;
+FAutoConsoleVariableRef CVARMaxWeaponShotsPerFrame(
+    TEXT("COOP.MaxWeaponShotsPerFrame"),
+    MaxWeaponShotsPerFrame,
+    TEXT("Most shots a single weapon fires in one frame, shots owed beyond that after a hitch are dropped"),
+    ECVF_Default);
+
+void UCSWeaponSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // Shots fired here queue their traces, resolve them in the same frame
+    AdvanceFiring();
+
+    FlushTraces();
+
+    // Shot inputs carry the hit claims, send them once every trace of the frame is resolved
+    SendFireInputs();
+}
+
+TStatId UCSWeaponSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UCSWeaponSubsystem, STATGROUP_Tickables);
+}
+
+bool UCSWeaponSubsystem::IsTraceBatchingEnabled()
+{
+    return BatchWeaponTraces != 0;
+}
+
+void UCSWeaponSubsystem::QueueTrace(ACSWeapon* Weapon, const FCSWeaponShot& Shot, const FCollisionQueryParams& QueryParams)
+{
+    FCSWeaponTraceRequest& Request = PendingTraces.AddDefaulted_GetRef();
+    Request.Weapon = Weapon;
+    Request.Shot = Shot;
+    Request.QueryParams = QueryParams;
+}
+
+void UCSWeaponSubsystem::QueuePelletTraces(ACSWeapon* Weapon, TArrayView<const FCSWeaponShot> Pellets, const FCollisionQueryParams& QueryParams)
+{
+    if (Pellets.Num() == 0)
+        return;
+
+    const int32 FirstIndex = PendingTraces.Num();
+
+    for (const FCSWeaponShot& Pellet : Pellets)
+    {
+        FCSWeaponTraceRequest& Request = PendingTraces.AddDefaulted_GetRef();
+        Request.Weapon = Weapon;
+        Request.Shot = Pellet;
+        Request.QueryParams = QueryParams;
+        Request.NumPellets = 0;
+    }
+
+    PendingTraces[FirstIndex].NumPellets = Pellets.Num();
+}
+
+void UCSWeaponSubsystem::StartFiring(ACSWeapon* Weapon)
+{
+    FiringWeapons.AddUnique(Weapon);
+}
+
+void UCSWeaponSubsystem::QueueFireInput(ACSWeapon* Weapon)
+{
+    InputWeapons.AddUnique(Weapon);
+}
+
+int32 UCSWeaponSubsystem::GetMaxShotsPerFrame()
+{
+    return FMath::Max(MaxWeaponShotsPerFrame, 1);
+}
+
+void UCSWeaponSubsystem::AdvanceFiring()
+{
+    if (FiringWeapons.Num() == 0)
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_WeaponFireAdvance);
+
+    UWorld* World = GetTickableGameObjectWorld();
+    if (World == nullptr)
+    {
+        FiringWeapons.Reset();
+        return;
+    }
+
+    const float Now = World->GetTimeSeconds();
+
+    // Weapons may start or stop firing while firing, only finished ones are removed afterwards
+    for (int32 Index = 0; Index < FiringWeapons.Num(); Index++)
+    {
+        ACSWeapon* Weapon = FiringWeapons[Index].Get();
+
+        if (Weapon && Weapon->IsFireScheduled())
+            Weapon->AdvanceFiring(Now, GetMaxShotsPerFrame());
+    }
+
+    FiringWeapons.RemoveAllSwap([](const TWeakObjectPtr<ACSWeapon>& Weapon)
+    {
+        return !Weapon.IsValid() || !Weapon->IsFireScheduled();
+    });
+}
+
+void UCSWeaponSubsystem::FlushTraces()
+{
+    if (PendingTraces.Num() == 0)
+        return;
+
+    SCOPE_CYCLE_COUNTER(STAT_WeaponTraceBatch);
+    INC_DWORD_STAT_BY(STAT_WeaponTraces, PendingTraces.Num());
+
+    UWorld* World = GetTickableGameObjectWorld();
+    if (World == nullptr)
+    {
+        PendingTraces.Reset();
+        return;
+    }
+
+    // Scene queries only read the physics scene, so the batch can be split across worker threads
+    const bool bSingleThreaded = PendingTraces.Num() < WeaponTraceParallelThreshold;
+
+    ParallelFor(PendingTraces.Num(), [this, World](int32 Index)
+    {
+        FCSWeaponTraceRequest& Request = PendingTraces[Index];
+
+        Request.bDidHit = World->LineTraceSingleByChannel(
+            Request.Hit, Request.Shot.TraceStart, Request.Shot.TraceEnd, COLLISION_WEAPON, Request.QueryParams);
+    }, bSingleThreaded);
+
+    // Weapons may queue new traces while handling results, those go to the next batch
+    TArray<FCSWeaponTraceRequest> ResolvedTraces = MoveTemp(PendingTraces);
+    PendingTraces.Reset();
+
+    for (int32 Index = 0; Index < ResolvedTraces.Num();)
+    {
+        const FCSWeaponTraceRequest& Request = ResolvedTraces[Index];
+        const int32 NumTraces = FMath::Max(Request.NumPellets, 1);
+
+        ACSWeapon* Weapon = Request.Weapon.Get();
+
+        // The pellets of a shot are merged per target, hand them over together
+        if (Weapon && Request.NumPellets > 1)
+            Weapon->OnPelletsTraced(MakeArrayView(&ResolvedTraces[Index], NumTraces));
+        else if (Weapon)
+            Weapon->OnShotTraced(Request.Shot, Request.Hit, Request.bDidHit);
+
+        Index += NumTraces;
+    }
+}
+
+void UCSWeaponSubsystem::SendFireInputs()
+{
+    if (InputWeapons.Num() == 0)
+        return;
+
+    INC_DWORD_STAT_BY(STAT_WeaponFireInputs, InputWeapons.Num());
+
+    // Weapons with redundant inputs left queue themselves again for the next frame
+    TArray<TWeakObjectPtr<ACSWeapon>> SendingWeapons = MoveTemp(InputWeapons);
+    InputWeapons.Reset();
+
+    for (const TWeakObjectPtr<ACSWeapon>& Weapon : SendingWeapons)
+    {
+        if (Weapon.IsValid())
+            Weapon->SendFireInput();
+    }
+}
+
+void UCSWeaponSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+    Super::OnWorldCleanup(World, bSessionEnded, bCleanupResources);
+
+    PendingTraces.Reset();
+    FiringWeapons.Reset();
+    InputWeapons.Reset();
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "CSBotPathSubsystem.generated.h"
+
+class ACSTrackerBot;
+
+/** Path found towards a target, shared by every bot chasing it */
+struct FCSSharedPath
+{
+    /** Points of the path, starting where the first requester was */
+    TArray<FVector> PathPoints;
+
+    /** Where the target was when the path was found */
+    FVector TargetLocation;
+
+    /** World time the path was found at */
+    float Time;
+
+    FCSSharedPath()
+        : TargetLocation(FVector::ZeroVector)
+        , Time(0.0f)
+    {
+    }
+};
+
+/** A bot waiting for a path query to be issued */
+struct FCSBotPathRequest
+{
+    TWeakObjectPtr<ACSTrackerBot> Bot;
+
+    TWeakObjectPtr<AActor> Target;
+};
+
+/**
+ * [server] Finds paths for tracker bots with async navigation queries, a limited number per frame.
+ * Paths are cached per target so bots chasing the same player reuse them until the player moves away.
+ */
+UCLASS(Config = Game)
+class UE4COOP_API UCSBotPathSubsystem : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    UCSBotPathSubsystem();
+
+    /** Begin FTickableGameObject Interface */
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Find the next path point of a bot towards a target, delivered through ACSTrackerBot::SetNextPathPoint */
+    void RequestPath(ACSTrackerBot* Bot, AActor* Target);
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Try to serve a bot from the path cached for its target */
+    bool TryUseSharedPath(ACSTrackerBot* Bot, AActor* Target);
+
+    /** Issue an async path query for a bot */
+    bool FindPathAsync(ACSTrackerBot* Bot, AActor* Target);
+
+    /** Async query finished, cache the path and hand it to the bot */
+    void OnPathFound(uint32 QueryID, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path, TWeakObjectPtr<ACSTrackerBot> Bot, TWeakObjectPtr<AActor> Target);
+
+    /** Max async path queries issued per frame */
+    UPROPERTY(Config)
+    int32 MaxQueriesPerFrame;
+
+    /** A cached path is recomputed once its target moved further than this */
+    UPROPERTY(Config)
+    float RepathDistance;
+
+    /** A cached path is recomputed once it is older than this */
+    UPROPERTY(Config)
+    float MaxPathAge;
+
+    /** Bots closer than this to a point of a cached path follow it instead of querying their own */
+    UPROPERTY(Config)
+    float ShareRadius;
+
+private:
+
+    /** Bots waiting for a query to be issued, in request order */
+    TArray<FCSBotPathRequest> PendingRequests;
+
+    /** Bots with a query in flight */
+    TSet<TWeakObjectPtr<ACSTrackerBot>> BotsInFlight;
+
+    /** Last path found towards each target */
+    TMap<TWeakObjectPtr<AActor>, FCSSharedPath> SharedPaths;
+};
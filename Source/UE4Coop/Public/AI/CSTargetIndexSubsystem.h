@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "CSTargetIndexSubsystem.generated.h"
+
+class ACSCharacter;
+
+/**
+ * [server] Uniform grid of the live, player controlled characters bots can go after.
+ * Targets are added and removed as they spawn and die, and moved between cells once per frame.
+ */
+UCLASS(Config = Game)
+class UE4COOP_API UCSTargetIndexSubsystem : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    UCSTargetIndexSubsystem();
+
+    /** Begin FTickableGameObject Interface */
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Start tracking a live player character */
+    void RegisterTarget(ACSCharacter* Target);
+
+    /** Stop tracking a character that died or is no longer controlled by a player */
+    void UnregisterTarget(ACSCharacter* Target);
+
+    /** Find the closest tracked target to a location, nullptr if there is none */
+    ACSCharacter* FindNearestTarget(const FVector& Location) const;
+
+    /** Number of tracked targets */
+    int32 GetNumTargets() const;
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Grid cell containing a location */
+    FIntPoint GetCell(const FVector& Location) const;
+
+    /** Add a target to a grid cell */
+    void AddToCell(ACSCharacter* Target, const FIntPoint& Cell);
+
+    /** Remove a target from a grid cell */
+    void RemoveFromCell(ACSCharacter* Target, const FIntPoint& Cell);
+
+    /** Size of a grid cell in world units */
+    UPROPERTY(Config)
+    float CellSize;
+
+private:
+
+    /** Targets in each occupied cell */
+    TMap<FIntPoint, TArray<ACSCharacter*, TInlineAllocator<4>>> Cells;
+
+    /** Tracked targets and the cell they are in */
+    TMap<ACSCharacter*, FIntPoint> TargetCells;
+
+    /** Bounds of the occupied cells, used to stop searching early */
+    FIntPoint MinCell;
+    FIntPoint MaxCell;
+};
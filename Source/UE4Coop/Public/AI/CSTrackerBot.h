@@ -4,20 +4,47 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
+#include "CSHealthOwner.h"
+#include "CSPoolableActor.h"
 #include "CSTrackerBot.generated.h"
 
 class USoundCue;
 class USphereComponent;
 class UParticleSystem;
 class UCSHealthComponent;
+class UCSHitboxHistoryComponent;
 class UStaticMeshComponent;
 class UMaterialInstanceDynamic;
 
+/** Movement tick intervals of a tracker bot by distance to the nearest player */
+struct FCSTrackerBotTickBands
+{
+    /** Players closer than this make the bot tick at NearInterval */
+    float NearDistance;
+
+    /** Players further than this make the bot tick at FarInterval */
+    float FarDistance;
+
+    float NearInterval;
+
+    float FarInterval;
+
+    /** Tick interval for a given distance to the nearest player, blended in between the bands */
+    float GetInterval(float DistanceToPlayer) const
+    {
+        const float Alpha = FMath::GetRangePct(NearDistance, FarDistance, DistanceToPlayer);
+
+        return FMath::Lerp(NearInterval, FarInterval, FMath::Clamp(Alpha, 0.0f, 1.0f));
+    }
+};
+
 UCLASS()
-class UE4COOP_API ACSTrackerBot : public APawn
+class UE4COOP_API ACSTrackerBot : public APawn, public ICSHealthOwner, public ICSPoolableActor
 {
 	GENERATED_BODY()
 
+    friend class UCSTrackerBotManager;
+
 public:
 	// Sets default values for this pawn's properties
 	ACSTrackerBot();
@@ -26,17 +53,45 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     UFUNCTION()
     void OnDamageTaken(UCSHealthComponent* OwningHealthComp, float Health, float Damage, const class UDamageType* DamageType, 
                        class AController* InstigatedBy, AActor* DamageCauser);
 
     void SelfDestruct();
 
+    /** Undo the self destruction, the bot is reused by the actor pool */
+    void RestoreFromExplosion();
+
+    /** [server] Hand the exploded bot back to the actor pool */
+    void ReleaseToPool();
+
+    /** Turn collision off while the bot waits in the actor pool */
+    UFUNCTION()
+    void OnRep_Pooled();
+
     void ApplySelfDamage();
 
     void RefreshPath();
 
-    FVector GetNextPathPoint();
+    /** [server] Ask the path subsystem for the next point towards the nearest player */
+    void RequestNextPathPoint();
+
+    /** [server] Tick less often the further the bot is from the nearest player */
+    void UpdateTickInterval(float DistanceToPlayer);
+
+    /** Movement tick interval for a given distance to the nearest player */
+    float GetTickIntervalForDistance(float DistanceToPlayer) const;
+
+    /** Significance settings of the bot, copied by the tracker bot manager */
+    FCSTrackerBotTickBands GetTickBands() const;
+
+    /** [server] Hand the steering over to the tracker bot manager */
+    void RegisterWithManager();
+
+    /** [server] Take the steering back from the tracker bot manager */
+    void UnregisterFromManager();
 
 protected:
     UPROPERTY(VisibleDefaultsOnly, Category = "Components")
@@ -48,6 +103,9 @@ protected:
     UPROPERTY(VisibleDefaultsOnly, Category = "Components")
     UCSHealthComponent* HealthComp;
 
+    UPROPERTY(VisibleDefaultsOnly, Category = "Components")
+    UCSHitboxHistoryComponent* HitboxHistoryComp;
+
     UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
     UParticleSystem* ExplosionEffect;
 
@@ -72,6 +130,22 @@ protected:
     UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
     bool bUseVelocityChange;
 
+    /** Movement tick interval when a player is closer than SignificanceNearDistance */
+    UPROPERTY(EditDefaultsOnly, Category = "TrackerBot|Significance", meta = (ClampMin = 0.0f))
+    float NearTickInterval;
+
+    /** Movement tick interval when every player is further than SignificanceFarDistance */
+    UPROPERTY(EditDefaultsOnly, Category = "TrackerBot|Significance", meta = (ClampMin = 0.0f))
+    float FarTickInterval;
+
+    /** Players closer than this make the bot tick at NearTickInterval */
+    UPROPERTY(EditDefaultsOnly, Category = "TrackerBot|Significance", meta = (ClampMin = 0.0f))
+    float SignificanceNearDistance;
+
+    /** Players further than this make the bot tick at FarTickInterval */
+    UPROPERTY(EditDefaultsOnly, Category = "TrackerBot|Significance", meta = (ClampMin = 0.0f))
+    float SignificanceFarDistance;
+
     UPROPERTY(EditDefaultsOnly, Category = "TrackerBot")
     USoundCue* SelfDestructSound;
 
@@ -80,6 +154,9 @@ protected:
 
     FVector NextPathPoint;
 
+    /** Slot in the tracker bot manager, INDEX_NONE when the bot steers itself */
+    int32 ManagerSlot;
+
     // Dynamic material to pulse on
     UMaterialInstanceDynamic* PulsingMaterialInstance;
 
@@ -87,13 +164,35 @@ protected:
 
     bool bStartedSelfDestruction;
 
+    /** Whether the bot is stored in the actor pool */
+    UPROPERTY(Transient, ReplicatedUsing = OnRep_Pooled)
+    bool bPooled;
+
     FTimerHandle TimerHandle_SelfDamage;
 
     FTimerHandle TimerHandle_RefreshPath;
 
+    FTimerHandle TimerHandle_ReleaseToPool;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
     virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
+
+    /** [server] Path point to move towards, delivered by the path subsystem */
+    void SetNextPathPoint(const FVector& PathPoint);
+
+    /** Whether COOP.DebugTrackerBots is set */
+    static bool IsDebugDrawingEnabled();
+
+    /** Begin ICSHealthOwner Interface */
+    virtual UCSHealthComponent* GetHealthComponent() const override;
+    /** End ICSHealthOwner Interface */
+
+    /** Begin ICSPoolableActor Interface */
+    virtual void OnAcquiredFromPool_Implementation() override;
+    virtual void OnReleasedToPool_Implementation() override;
+    virtual void SetPooled(bool bNewPooled) override;
+    /** End ICSPoolableActor Interface */
 };
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "CSTrackerBot.h"
+#include "CSTrackerBotManager.generated.h"
+
+
+/**
+ * [server] Steers every registered tracker bot in one pass instead of one actor tick per bot.
+ * Steering state is kept in parallel arrays indexed by the bot's slot, registered bots don't tick.
+ */
+UCLASS()
+class UE4COOP_API UCSTrackerBotManager : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Begin FTickableGameObject Interface */
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Whether new bots should be steered by the manager instead of their own tick */
+    static bool IsBatchingEnabled();
+
+    /** Take over the steering of a bot, returns its slot */
+    int32 RegisterBot(ACSTrackerBot* Bot);
+
+    /** Stop steering a bot, its slot is reused */
+    void UnregisterBot(ACSTrackerBot* Bot);
+
+    /** Set the point a registered bot moves towards */
+    void SetNextPathPoint(int32 Slot, const FVector& PathPoint);
+
+    /** Number of steered bots */
+    int32 GetNumBots() const;
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Compute the steering of the bots due for an update, reads only the arrays */
+    void UpdateSteering(int32 Slot);
+
+private:
+
+    /** Steered bots */
+    TArray<ACSTrackerBot*> Bots;
+
+    /** Bot locations gathered at the start of the frame */
+    TArray<FVector> Positions;
+
+    /** Points the bots move towards */
+    TArray<FVector> NextPathPoints;
+
+    /** Steering force computed for the current update */
+    TArray<FVector> Forces;
+
+    /** Distance at which a bot considers its path point reached */
+    TArray<float> RequiredDistances;
+
+    /** Steering force of each bot */
+    TArray<float> MovementForces;
+
+    /** Tick interval bands of each bot */
+    TArray<FCSTrackerBotTickBands> TickBands;
+
+    /** Distance to the nearest player, gathered at the start of the frame for the bots due for an update */
+    TArray<float> TargetDistances;
+
+    /** Time between steering updates, from the distance to the nearest player */
+    TArray<float> UpdateIntervals;
+
+    /** Time since the last steering update */
+    TArray<float> TimeSinceUpdate;
+
+    /** Result of the current update, see EBotUpdate in the cpp */
+    TArray<uint8> UpdateResults;
+};
@@ -7,7 +7,8 @@
 #include "CSAttributeSet.generated.h"
 
 /**
- * 
+ * Attributes of characters with an ability system, the health component reads its health from here.
+ * Damage is a server only meta attribute, written by UCSDamageExecution and turned into a health change.
  */
 UCLASS()
 class UE4COOP_API UCSAttributeSet : public UAttributeSet
@@ -18,16 +19,30 @@ public:
 
     UCSAttributeSet();
 
-    UPROPERTY(Category = "Character Attributes", EditAnywhere, BlueprintReadWrite)
+    UPROPERTY(Category = "Character Attributes", EditAnywhere, BlueprintReadWrite, ReplicatedUsing = OnRep_Health)
     FGameplayAttributeData Health;
 
-    UPROPERTY(Category = "Character Attributes", EditAnywhere, BlueprintReadWrite)
+    UPROPERTY(Category = "Character Attributes", EditAnywhere, BlueprintReadWrite, ReplicatedUsing = OnRep_MaxHealth)
     FGameplayAttributeData MaxHealth;
 
+    /** [server] Incoming damage of the effect being executed, never replicated */
+    UPROPERTY(Category = "Character Attributes", BlueprintReadOnly)
+    FGameplayAttributeData Damage;
+
 public:
 
     virtual void PreAttributeBaseChange(const FGameplayAttribute& Attribute, float& NewValue) const override;
     virtual void PostGameplayEffectExecute(const struct FGameplayEffectModCallbackData &Data) override;
 
     static FGameplayAttribute HealthAttribute();
+    static FGameplayAttribute MaxHealthAttribute();
+    static FGameplayAttribute DamageAttribute();
+
+protected:
+
+    UFUNCTION()
+    void OnRep_Health();
+
+    UFUNCTION()
+    void OnRep_MaxHealth();
 };
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayEffect.h"
+#include "CSDamageEffect.generated.h"
+
+/**
+ * Instant effect applying the damage of a UE damage event through UCSDamageExecution.
+ * Blueprint damage effects can be made from it, the damage is set with the Data.Damage tag.
+ */
+UCLASS()
+class UE4COOP_API UCSDamageEffect : public UGameplayEffect
+{
+    GENERATED_BODY()
+
+public:
+
+    UCSDamageEffect();
+};
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayEffectExecutionCalculation.h"
+#include "GameplayTagContainer.h"
+#include "CSDamageExecution.generated.h"
+
+/**
+ * [server] Turns the Data.Damage set by caller magnitude of a damage effect into the Damage meta attribute.
+ * Damage modifiers of the source or the target belong here.
+ */
+UCLASS()
+class UE4COOP_API UCSDamageExecution : public UGameplayEffectExecutionCalculation
+{
+    GENERATED_BODY()
+
+public:
+
+    virtual void Execute_Implementation(const FGameplayEffectCustomExecutionParameters& ExecutionParams, FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const override;
+
+    /** Set by caller tag holding the damage of the effect */
+    static FGameplayTag GetDamageTag();
+};
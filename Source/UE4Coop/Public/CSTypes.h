@@ -7,4 +7,6 @@
 #define SURFACE_FLESHDEFAULT        SurfaceType1
 #define SURFACE_FLESHVULNERABLE     SurfaceType2
 
-#define COLLISION_WEAPON            ECC_GameTraceChannel1
\ No newline at end of file
+#define COLLISION_WEAPON            ECC_GameTraceChannel1
+
+DECLARE_STATS_GROUP(TEXT("Coop"), STATGROUP_Coop, STATCAT_Advanced);
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "CSWorldSubsystem.generated.h"
+
+/**
+ * Base for game systems that manage state of the current world of a game instance.
+ * Ticks once per frame after all actors and timers, and drops its world state on cleanup.
+ */
+UCLASS(Abstract)
+class UE4COOP_API UCSWorldSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Begin USubsystem Interface */
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    /** End USubsystem Interface */
+
+    /** Begin FTickableGameObject Interface */
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override;
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Get the subsystem of the game instance owning the world of the context object */
+    template<class T>
+    static T* Get(const UObject* WorldContextObject)
+    {
+        UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+        UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+
+        return GameInstance ? GameInstance->GetSubsystem<T>() : nullptr;
+    }
+
+protected:
+
+    /** Called when a world is torn down, release anything that belongs to it */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+private:
+
+    /** Forward cleanup of worlds belonging to our game instance */
+    void HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+    /** Is the subsystem initialized and allowed to tick */
+    bool bInitialized;
+
+    /** Handle for the world cleanup delegate */
+    FDelegateHandle WorldCleanupHandle;
+};
@@ -5,11 +5,13 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "AbilitySystemInterface.h"
+#include "CSHealthOwner.h"
 #include "CSCharacter.generated.h"
 
 class UCameraComponent;
 class USpringArmComponent;
 class UCSHealthComponent;
+class UCSHitboxHistoryComponent;
 class ACSWeapon;
 class UGameplayAbility;
 class UCSAttributeSet;
@@ -42,7 +44,7 @@ enum class ECharacterAction : uint8
 };
 
 UCLASS()
-class UE4COOP_API ACSCharacter : public ACharacter, public IAbilitySystemInterface
+class UE4COOP_API ACSCharacter : public ACharacter, public IAbilitySystemInterface, public ICSHealthOwner
 {
     GENERATED_BODY()
 
@@ -60,7 +62,9 @@ protected:
     virtual void BeginPlay() override;
     virtual void Tick(float DeltaTime) override;
     virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void PossessedBy(AController* NewController) override;
+    virtual void UnPossessed() override;
     virtual FVector GetPawnViewLocation() const override;
     /** End ACharacter Interface */
 
@@ -179,6 +183,9 @@ protected:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
     UCSHealthComponent* HealthComp;
 
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+    UCSHitboxHistoryComponent* HitboxHistoryComp;
+
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess="true"))
     UAbilitySystemComponent* AbilitySystem;
 
@@ -254,7 +261,7 @@ public:
 
     // Get health component
     UFUNCTION(BlueprintCallable, Category = "Character")
-    UCSHealthComponent* GetHealthComponent() const;
+    virtual UCSHealthComponent* GetHealthComponent() const override;
 
     /** Check if pawn is aiming down sights */
     UFUNCTION(BlueprintCallable, Category = "Character")
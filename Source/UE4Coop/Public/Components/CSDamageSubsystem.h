@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "CSHealthComponent.h"
+#include "CSDamageSubsystem.generated.h"
+
+class AController;
+class UDamageType;
+
+/** A hit taken by a health component, waiting for the end of the frame */
+struct FCSPendingDamage
+{
+    TWeakObjectPtr<UCSHealthComponent> Victim;
+
+    float Damage;
+
+    const UDamageType* DamageType;
+
+    TWeakObjectPtr<AController> InstigatedBy;
+
+    TWeakObjectPtr<AActor> DamageCauser;
+};
+
+/** Every hit a health component took during a frame, merged */
+struct FCSDamageVictim
+{
+    UCSHealthComponent* HealthComp;
+
+    /** Health the victim is left with after the hits so far */
+    float Health;
+
+    /** Sum of the damage of the hits up to the killing one */
+    float Damage;
+
+    /** Damage type, instigator and causer of the last hit counted, the killing hit when the victim dies */
+    const UDamageType* DamageType;
+
+    TWeakObjectPtr<AController> InstigatedBy;
+
+    TWeakObjectPtr<AActor> DamageCauser;
+
+    /** Health taken by each damage causer */
+    TArray<FCSDamageContribution, TInlineAllocator<4>> Contributions;
+
+    /** Index of the first hit, or of the killing hit, so deaths resolve in the order they happened */
+    int32 HitIndex;
+};
+
+/**
+ * [server] Collects the hits health components take during a frame and resolves them once per victim
+ * at the end of the frame, instead of broadcasting events, sending RPCs and registering statistics per hit.
+ * Hits are replayed in the order they arrived to keep the killer, the damage done by each causer
+ * and the order of deaths exactly as if they had been applied one by one.
+ * Also sends the damage feedback of damaged players, at most once per net update of each of them.
+ */
+UCLASS()
+class UE4COOP_API UCSDamageSubsystem : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Begin FTickableGameObject Interface */
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Whether health components should queue their damage instead of applying it right away */
+    static bool IsDamageCoalescingEnabled();
+
+    /** Queue a hit, applied with the other hits of the victim at the end of the frame */
+    void QueueDamage(UCSHealthComponent* Victim, float Damage, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser);
+
+    /** Send the damage feedback of a health component with its next net update */
+    void QueueDamageFeedback(UCSHealthComponent* HealthComp);
+
+    /** Whether the hits queued this frame kill a health component, it is still alive until they are resolved */
+    bool IsDoomed(const UCSHealthComponent* HealthComp) const;
+
+    /**
+     * Merge hits per victim, replaying them in order. OutVictims are sorted by their killing hit, or their first hit when they survive.
+     * OutVictimIndices is only used while merging, both are passed in to reuse their memory.
+     */
+    static void MergeHits(const TArray<FCSPendingDamage>& Hits, TArray<FCSDamageVictim>& OutVictims, TMap<UCSHealthComponent*, int32>& OutVictimIndices);
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Apply the hits queued this frame */
+    void ResolveDamage();
+
+    /** Send the damage feedback of health components due for a net update */
+    void FlushDamageFeedback();
+
+private:
+
+    /** Hits taken this frame, in the order they arrived */
+    TArray<FCSPendingDamage> PendingDamage;
+
+    /** Health each victim is left with once the hits queued this frame are resolved */
+    TMap<const UCSHealthComponent*, float> PendingHealth;
+
+    /** Victims of the hits being resolved */
+    TArray<FCSDamageVictim> Victims;
+
+    /** Index of each victim in Victims */
+    TMap<UCSHealthComponent*, int32> VictimIndices;
+
+    /** Health components with damage feedback to send */
+    TArray<TWeakObjectPtr<UCSHealthComponent>> FeedbackComponents;
+};
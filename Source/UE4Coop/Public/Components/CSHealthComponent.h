@@ -4,10 +4,70 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "CSTeamAttitude.h"
 #include "CSHealthComponent.generated.h"
 
+/** What a health component counts as in the game mode live counters */
+enum class ECSLiveCounter : uint8
+{
+    None,
+    Bot,
+    Player,
+};
+
+class UAbilitySystemComponent;
+class APlayerState;
+struct FOnAttributeChangeData;
+
+/** Health taken by one damage causer, when several hits are applied at once */
+struct FCSDamageContribution
+{
+    TWeakObjectPtr<AActor> DamageCauser;
+
+    float Damage;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_SixParams(FOnHealthChangedSignature, UCSHealthComponent*, HealthComp, float, Health, float, Damage, const class UDamageType*, DamageType, class AController*, InstigatedBy, AActor*, DamageCauser);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FOnDamageFeedbackSignature, UCSHealthComponent*, HealthComp, float, Damage, FVector, DamageDirection, APlayerState*, InstigatorState);
+
+/** Cosmetic report of damage taken, sent to the damaged player */
+USTRUCT()
+struct FCSDamageFeedback
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Damage rounded to whole points */
+    UPROPERTY()
+    uint16 Amount;
 
+    /** World yaw from the victim towards the damage causer, compressed to a byte */
+    UPROPERTY()
+    uint8 DirectionYaw;
+
+    /** Whether the damage came from somewhere, DirectionYaw is meaningless otherwise */
+    UPROPERTY()
+    bool bHasDirection;
+
+    /** PlayerId of the instigating player, INDEX_NONE for bots and the world */
+    UPROPERTY()
+    int32 InstigatorId;
+
+    FCSDamageFeedback()
+    {
+        Amount = 0;
+        DirectionYaw = 0;
+        bHasDirection = false;
+        InstigatorId = INDEX_NONE;
+    }
+};
+
+/**
+ * Health of an actor, damage and healing go through here.
+ * When the owner has an ability system with a UCSAttributeSet, the health lives in the Health attribute
+ * and damage is applied as a UCSDamageEffect, otherwise the component keeps and replicates its own health.
+ */
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class UE4COOP_API UCSHealthComponent : public UActorComponent
 {
@@ -24,9 +84,30 @@ protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+    /** [server] Apply damage from a UE damage event as a damage effect, comes back through HandleAttributeDamage */
+    void ApplyDamageEffect(float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
+
+    /** [server] Everything that follows a health loss: events, death, kill credit. Contributions split the credit between several causers */
+    void HandleDamage(float OldHealth, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser,
+        TArrayView<const FCSDamageContribution> Contributions = TArrayView<const FCSDamageContribution>());
+
+    /** [client] Health attribute replicated, the attribute version of OnRep_Health */
+    void OnHealthAttributeChanged(const FOnAttributeChangeData& Data);
+
+    /** What the owner should be counted as right now */
+    ECSLiveCounter GetOwnerLiveCounter() const;
+
+    /** What the owner is currently counted as by the game mode */
+    ECSLiveCounter LiveCounter;
+
     UPROPERTY(Transient, Replicated)
     bool bIsDead;
 
+    /** Health of owners without an attribute set, not replicated otherwise */
     UPROPERTY(ReplicatedUsing = OnRep_Health, BlueprintReadOnly, Category="HealthComponent")
     float Health;
 
@@ -36,6 +117,25 @@ protected:
     UFUNCTION()
     void OnRep_Health(float OldHealth);
 
+    /** Ability system of the owner holding the health attribute, nullptr if the component keeps its own health */
+    UPROPERTY(Transient)
+    UAbilitySystemComponent* AbilitySystem;
+
+    /** [server] Damage type of the damage event being applied through the ability system */
+    const class UDamageType* PendingDamageType;
+
+    /** [server] Damage causers of the hits being applied through the ability system */
+    TArrayView<const FCSDamageContribution> PendingContributions;
+
+    /** [server] Damage feedback for the owning player, not sent yet */
+    TArray<FCSDamageFeedback> PendingDamageFeedback;
+
+    /** [server] World time the pending damage feedback may be sent at, once per net update of the owner */
+    float NextDamageFeedbackTime;
+
+    /** [server] Buffer a damage report for the owning player, sent with the next net update */
+    void AddDamageFeedback(float Damage, class AController* InstigatedBy, AActor* DamageCauser);
+
  public:
 
     UFUNCTION(BlueprintCallable, Category = "HealthComponent")
@@ -47,17 +147,63 @@ protected:
     UFUNCTION(BlueprintCallable, Category = "HealthComponent")
     bool IsDead() const;
 
+    /** [server] Whether we are dead or killed by damage queued for the end of the frame */
+    bool IsDeadOrDoomed() const;
+
     UPROPERTY(BlueprintAssignable, Category = "Events")
     FOnHealthChangedSignature OnHealthChanged;
 
     UFUNCTION(BlueprintCallable, Category = "HealthComponent")
     void ApplyHeal(float HealAmount);
 
+    /** [server] Bring the owner back to full health, also when dead, used when it is reused by the actor pool */
+    void ResetHealth();
+
+    /** Whether ActorA is allied with ActorB, actors without a health component are considered friendly */
     UFUNCTION(BlueprintCallable, BlueprintPure, Category = "HealthComponent")
     static bool IsFriendly(AActor* ActorA, AActor* ActorB);
 
-    UFUNCTION(Reliable, Client, WithValidation)
-    void ClientDamageTaken(float Damage, class AController* InstigatedBy, AActor* DamageCauser);
+    /** Whether ActorA is hostile towards ActorB */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "HealthComponent")
+    static bool IsHostile(AActor* ActorA, AActor* ActorB);
+
+    /**
+    * Attitude of ActorA towards ActorB, from the game mode team table on the server.
+    * Clients don't have the table and only know whether both are in the same team.
+    */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "HealthComponent")
+    static ECSTeamAttitude GetTeamAttitude(AActor* ActorA, AActor* ActorB);
+
+    /** What a health component owner is counted as by the game mode */
+    static ECSLiveCounter GetLiveCounter(bool bIsPawn, bool bIsPlayerControlled, bool bIsDead);
+
+    /** Health component of an actor, direct for ICSHealthOwner actors, otherwise searched in its components */
+    UFUNCTION(BlueprintCallable, BlueprintPure, Category = "HealthComponent")
+    static UCSHealthComponent* FindHealthComponent(const AActor* Actor);
+
+    /** [server] Apply damage that passed the team checks, Contributions credit each causer when several hits are merged */
+    void ApplyDamage(float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser,
+        TArrayView<const FCSDamageContribution> Contributions = TArrayView<const FCSDamageContribution>());
+
+    /** Health left after taking Damage with CurrentHealth, clamped like the health itself */
+    float GetHealthAfterDamage(float CurrentHealth, float Damage) const;
+
+    /** [server] Damage executed on the health attribute, called by the attribute set */
+    void HandleAttributeDamage(float OldHealth, float Damage, class AController* InstigatedBy, AActor* DamageCauser);
+
+    /** [server] Move the owner to the right game mode live counter, call when it may have been possessed or unpossessed */
+    void UpdateLiveCounter(bool bRemoved = false);
+
+    /** [server] Send the buffered damage feedback, returns false when it has to wait for the next net update */
+    bool FlushDamageFeedback();
+
+    /** [client] Damage taken since the last net update, rebroadcast as OnDamageFeedback, and as OnTakeAnyDamage on remote clients only */
+    UFUNCTION(Unreliable, Client)
+    void ClientDamageFeedback(const TArray<FCSDamageFeedback>& Feedback);
+
+    /** [client] Damage taken by a player, with the direction it came from, zero if unknown */
+    UPROPERTY(BlueprintAssignable, Category = "Events")
+    FOnDamageFeedbackSignature OnDamageFeedback;
 
     UFUNCTION()
     void OnDamageTaken(AActor* DamagedActor, float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
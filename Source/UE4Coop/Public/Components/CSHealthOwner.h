@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "CSHealthOwner.generated.h"
+
+class UCSHealthComponent;
+
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class UCSHealthOwner : public UInterface
+{
+    GENERATED_BODY()
+};
+
+/** Actors owning a health component, gives direct access to it instead of searching their components */
+class UE4COOP_API ICSHealthOwner
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Returns the health component of this actor */
+    virtual UCSHealthComponent* GetHealthComponent() const = 0;
+};
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CSHitboxHistoryComponent.generated.h"
+
+class USkeletalMeshComponent;
+
+/** Hitbox of the owner recorded at a given server time */
+USTRUCT()
+struct FCSHitboxSnapshot
+{
+    GENERATED_BODY()
+
+    /** Server world time the snapshot was taken at */
+    float Time;
+
+    /** Center of the hitbox */
+    FVector Location;
+
+    /** Orientation of the hitbox */
+    FQuat Rotation;
+
+    /** Location of the vulnerable bone, only valid when the owner has one */
+    FVector VulnerableLocation;
+
+    FCSHitboxSnapshot()
+    {
+        Time = 0.0f;
+        Location = FVector::ZeroVector;
+        Rotation = FQuat::Identity;
+        VulnerableLocation = FVector::ZeroVector;
+    }
+};
+
+/**
+ * [server] Keeps a short ring buffer of the owner's hitbox so hits claimed by clients
+ * can be checked against where the owner was at the time the client saw it.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class UE4COOP_API UCSHitboxHistoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UCSHitboxHistoryComponent();
+
+protected:
+
+    /** Begin UActorComponent Interface */
+    virtual void BeginPlay() override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+    /** End UActorComponent Interface */
+
+    /** Store the current hitbox in the ring buffer */
+    void RecordSnapshot();
+
+public:
+
+    /**
+    * [server] Size the hitbox and allocate the ring buffer, done on begin play
+    *
+    * @param Radius                 Hitbox capsule radius
+    * @param HalfHeight             Hitbox capsule half height
+    * @param bTrackVulnerableBone   Whether snapshots record the vulnerable bone
+    */
+    void InitHistory(float Radius, float HalfHeight, bool bTrackVulnerableBone);
+
+    /** [server] Store a hitbox in the ring buffer, it has to be newer than the previous one */
+    void AddSnapshot(const FCSHitboxSnapshot& Snapshot);
+
+    /** Get the interpolated hitbox at the given server time, returns false if there is no history */
+    bool GetSnapshotAtTime(float Time, FCSHitboxSnapshot& OutSnapshot) const;
+
+    /**
+    * [server] Rewind the owner to the given time and check the claimed hit against it
+    *
+    * @param Time           Server time the client saw the owner at
+    * @param TraceStart     Start of the client's trace
+    * @param TraceEnd       End of the client's trace
+    * @param ImpactPoint    Point the client claims to have hit
+    * @param bOutVulnerable Whether the trace passed through the rewound vulnerable bone
+    */
+    bool ConfirmHit(float Time, const FVector& TraceStart, const FVector& TraceEnd, const FVector& ImpactPoint, bool& bOutVulnerable) const;
+
+    /** [server] Whether a trace passes through the hitbox of a rewound snapshot, bOutVulnerable is whether it passes through its vulnerable bone */
+    bool TraceHitbox(const FCSHitboxSnapshot& Snapshot, const FVector& TraceStart, const FVector& TraceEnd, bool& bOutVulnerable) const;
+
+    /** Oldest time we are allowed to rewind to from now */
+    float GetMaxRewindTime() const;
+
+    /** [server] Forget every recorded hitbox, call when the owner is teleported */
+    void ClearHistory();
+
+protected:
+
+    /** Maximum number of snapshots kept in the ring buffer */
+    UPROPERTY(EditDefaultsOnly, Category = "HitboxHistory", meta = (ClampMin = 2))
+    int32 MaxSnapshots;
+
+    /** Never rewind further than this amount of seconds */
+    UPROPERTY(EditDefaultsOnly, Category = "HitboxHistory", meta = (ClampMin = 0.0f))
+    float MaxRewindTime;
+
+    /** Extra distance added to the hitbox to account for limbs and interpolation error */
+    UPROPERTY(EditDefaultsOnly, Category = "HitboxHistory", meta = (ClampMin = 0.0f))
+    float HitTolerance;
+
+    /** Bone of the owner mesh that takes vulnerable damage */
+    UPROPERTY(EditDefaultsOnly, Category = "HitboxHistory")
+    FName VulnerableBoneName;
+
+    /** Radius around the vulnerable bone a trace has to pass through to count as a vulnerable hit */
+    UPROPERTY(EditDefaultsOnly, Category = "HitboxHistory", meta = (ClampMin = 0.0f))
+    float VulnerableRadius;
+
+    /** Mesh the vulnerable bone is read from, nullptr if the owner doesn't have the bone */
+    UPROPERTY(Transient)
+    USkeletalMeshComponent* VulnerableMesh;
+
+    /** Whether snapshots record the vulnerable bone, hits are never vulnerable otherwise */
+    bool bHasVulnerableBone;
+
+    /** Hitbox capsule radius, taken from the owner root on begin play */
+    float HitboxRadius;
+
+    /** Hitbox capsule half height, taken from the owner root on begin play */
+    float HitboxHalfHeight;
+
+    /** Ring buffer of recorded hitboxes */
+    TArray<FCSHitboxSnapshot> Snapshots;
+
+    /** Index of the newest snapshot in the ring buffer */
+    int32 NewestSnapshotIndex;
+
+    /** Number of valid snapshots in the ring buffer */
+    int32 NumSnapshots;
+};
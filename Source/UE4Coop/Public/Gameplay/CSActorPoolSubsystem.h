@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "CSActorPoolSubsystem.generated.h"
+
+/** Free actors of a single class */
+USTRUCT()
+struct FCSActorPool
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(Transient)
+    TArray<AActor*> FreeActors;
+};
+
+/**
+ * [server] Reuses actors that are spawned and destroyed over and over (weapons, bots, power ups).
+ * Only actors implementing ICSPoolableActor are pooled, others are spawned and destroyed as usual.
+ */
+UCLASS(Config = Game)
+class UE4COOP_API UCSActorPoolSubsystem : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    UCSActorPoolSubsystem();
+
+    /** Begin FTickableGameObject Interface */
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Get an actor from the pool or spawn it, falls back to a regular spawn when there is no pool */
+    static AActor* Acquire(const UObject* WorldContextObject, UClass* ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr);
+
+    template<class T>
+    static T* Acquire(const UObject* WorldContextObject, TSubclassOf<T> ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr)
+    {
+        return Cast<T>(Acquire(WorldContextObject, *ActorClass, Transform, Owner, Instigator));
+    }
+
+    /** Put an actor back in the pool, falls back to destroying it when there is no pool */
+    static void Release(AActor* Actor);
+
+    /** Get an actor from the pool or spawn it */
+    AActor* AcquireActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr);
+
+    /** Put an actor back in the pool, destroys it if it is not poolable or the pool is full */
+    void ReleaseActor(AActor* Actor);
+
+    /** Spawn actors into the pool until it holds at least Count free ones */
+    void Prewarm(UClass* ActorClass, int32 Count);
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Spawn a new actor, outside of the pool */
+    AActor* SpawnActor(UClass* ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator);
+
+    /** Hide an actor and stop everything it does */
+    void DeactivateActor(AActor* Actor);
+
+    /** Max free actors kept per class, extra ones are destroyed on release */
+    UPROPERTY(Config)
+    int32 MaxPooledPerClass;
+
+private:
+
+    /** Free actors by class */
+    UPROPERTY(Transient)
+    TMap<UClass*, FCSActorPool> Pools;
+};
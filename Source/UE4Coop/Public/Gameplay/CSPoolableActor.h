@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "CSPoolableActor.generated.h"
+
+UINTERFACE(MinimalAPI)
+class UCSPoolableActor : public UInterface
+{
+    GENERATED_BODY()
+};
+
+/**
+ * Actors reused by the actor pool instead of being destroyed.
+ * BeginPlay only runs when the actor is first spawned, state has to be reset in the pool hooks.
+ */
+class UE4COOP_API ICSPoolableActor
+{
+    GENERATED_BODY()
+
+public:
+
+    /** [server] Taken back out of the pool, already moved, shown and with collision enabled */
+    UFUNCTION(BlueprintNativeEvent, Category = "Pooling")
+    void OnAcquiredFromPool();
+
+    /** [server] About to be hidden and stored in the pool, timers are cleared right after */
+    UFUNCTION(BlueprintNativeEvent, Category = "Pooling")
+    void OnReleasedToPool();
+
+    /** [server] Flag the actor as stored in the pool, replicated so clients turn its collision off too */
+    virtual void SetPooled(bool bNewPooled) = 0;
+};
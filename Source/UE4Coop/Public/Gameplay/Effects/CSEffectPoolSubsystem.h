@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "Engine/EngineTypes.h"
+#include "CSEffectPoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+class USceneComponent;
+
+/** Free particle components of a single template */
+USTRUCT()
+struct FCSEffectPool
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(Transient)
+    TArray<UParticleSystemComponent*> FreeComponents;
+};
+
+/**
+ * Reuses particle system components for short lived effects (muzzle flashes, tracers, impacts)
+ * instead of spawning and garbage collecting a new component for every shot.
+ */
+UCLASS(Config = Game)
+class UE4COOP_API UCSEffectPoolSubsystem : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    UCSEffectPoolSubsystem();
+
+    /** Begin FTickableGameObject Interface */
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Play a pooled effect at a location, falls back to a regular emitter when there is no pool */
+    static UParticleSystemComponent* PlayEffectAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator, EPhysicalSurface SurfaceType = SurfaceType_Max);
+
+    /** Play a pooled effect attached to a component, falls back to a regular emitter when there is no pool */
+    static UParticleSystemComponent* PlayEffectAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName = NAME_None);
+
+    /** Play an effect at a location, pass a surface type to cap the number of live impacts on it */
+    UParticleSystemComponent* SpawnEffectAtLocation(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator, EPhysicalSurface SurfaceType = SurfaceType_Max);
+
+    /** Play an effect attached to a component */
+    UParticleSystemComponent* SpawnEffectAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName = NAME_None);
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Get a reset component from the pool or create a new one */
+    UParticleSystemComponent* AcquireEffect(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation);
+
+    /** Put a finished component back in its pool */
+    void ReleaseEffect(UParticleSystemComponent* Effect);
+
+    /** Finished effects go back to the pool */
+    UFUNCTION()
+    void OnEffectFinished(UParticleSystemComponent* Effect);
+
+    /** Max free components kept per template, extra ones are destroyed when they finish */
+    UPROPERTY(Config)
+    int32 MaxPooledPerTemplate;
+
+    /** Max impacts alive at once on a single surface type, the oldest one is recycled above it */
+    UPROPERTY(Config)
+    int32 MaxImpactsPerSurface;
+
+private:
+
+    /** Free components by template */
+    UPROPERTY(Transient)
+    TMap<UParticleSystem*, FCSEffectPool> Pools;
+
+    /** Impacts currently playing per surface type, oldest first */
+    TArray<TWeakObjectPtr<UParticleSystemComponent>> LiveImpacts[SurfaceType_Max];
+};
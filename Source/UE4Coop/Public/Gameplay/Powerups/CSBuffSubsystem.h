@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "CSBuffSubsystem.generated.h"
+
+class ACSCharacter;
+class ACSPowerUpBase;
+
+/** An active periodic power up effect */
+struct FCSActiveBuff
+{
+    ACSPowerUpBase* PowerUp;
+
+    /** World time of the next power up tick */
+    float NextTickTime;
+};
+
+/**
+ * [server] Ticks every active periodic power up in one pass instead of one looping timer per power up.
+ * Buffs are kept in an array sorted by their next tick time, so the due ones are always at the front.
+ */
+UCLASS()
+class UE4COOP_API UCSBuffSubsystem : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Begin FTickableGameObject Interface */
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Start ticking an activated power up every PeriodicTimer seconds */
+    void AddBuff(ACSPowerUpBase* PowerUp);
+
+    /** Stop ticking a power up, safe to call from a power up tick */
+    void RemoveBuff(ACSPowerUpBase* PowerUp);
+
+    /** Active buff of the same class as a power up on a target, nullptr if there is none */
+    ACSPowerUpBase* FindBuff(UClass* PowerUpClass, const ACSCharacter* Target) const;
+
+    /** Number of active buffs */
+    int32 GetNumBuffs() const;
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Insert a buff at its place in the sorted array */
+    void InsertBuff(const FCSActiveBuff& Buff);
+
+private:
+
+    /** Active buffs sorted by NextTickTime */
+    TArray<FCSActiveBuff> Buffs;
+
+    /** Buffs taken off the front of the array for the current pass */
+    TArray<FCSActiveBuff> DueBuffs;
+};
@@ -4,14 +4,29 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "CSPoolableActor.h"
 #include "CSPowerUpBase.generated.h"
 
 class ACSCharacter;
 
+/** What picking up a power up does while one of the same class is active on the target */
+UENUM(BlueprintType)
+enum class ECSBuffStacking : uint8
+{
+    /** Both power ups are active */
+    Stack,
+    /** The active power up starts its ticks over, the new one is discarded */
+    Refresh,
+    /** The new power up is discarded */
+    Ignore,
+};
+
 UCLASS()
-class UE4COOP_API ACSPowerUpBase : public AActor
+class UE4COOP_API ACSPowerUpBase : public AActor, public ICSPoolableActor
 {
 	GENERATED_BODY()
+
+    friend class UCSBuffSubsystem;
 	
 public:	
 	// Sets default values for this actor's properties
@@ -19,12 +34,18 @@ public:
 
 protected:
 
-    UFUNCTION()
-    void OnTick();
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    /** Run one power up tick, returns false once the power up expired */
+    bool TickPowerUp();
 
     UFUNCTION()
     void OnRep_PowerUpActive();
 
+    /** Turn collision off while the power up waits in the actor pool */
+    UFUNCTION()
+    void OnRep_Pooled();
+
     UFUNCTION(BlueprintImplementableEvent, Category = "PowerUps")
     void OnPowerUpStateChanged(bool bNewIsActive);
 
@@ -35,15 +56,25 @@ protected:
     UPROPERTY(EditDefaultsOnly, Category = "PowerUps")
     int TotalNumberOfTicks;
 
+    /** What happens when the target picks this power up while already having one of the same class */
+    UPROPERTY(EditDefaultsOnly, Category = "PowerUps")
+    ECSBuffStacking Stacking;
+
     UPROPERTY(ReplicatedUsing=OnRep_PowerUpActive)
     bool bIsPowerUpActive;
 
+    /** Whether the power up is stored in the actor pool */
+    UPROPERTY(Transient, ReplicatedUsing = OnRep_Pooled)
+    bool bPooled;
+
     int TicksCounter;
 
+    /** Whether the blueprint implements OnPowerUpTicked, only then the event is called */
+    bool bHasTickEvent;
+
     UPROPERTY(BlueprintReadOnly, Category = "PowerUps")
     ACSCharacter* Target;
 
-    FTimerHandle TimerHandle_PowerUpTick;
 public:	
 
     UFUNCTION(BlueprintImplementableEvent, Category = "PowerUps")
@@ -56,4 +87,10 @@ public:
     void OnExpired();
 
     void Activate(ACSCharacter* TargetPawn);
+
+    /** Begin ICSPoolableActor Interface */
+    virtual void OnAcquiredFromPool_Implementation() override;
+    virtual void OnReleasedToPool_Implementation() override;
+    virtual void SetPooled(bool bNewPooled) override;
+    /** End ICSPoolableActor Interface */
 };
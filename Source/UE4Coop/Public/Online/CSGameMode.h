@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameMode.h"
+#include "CSTeamAttitude.h"
 #include "CSGameMode.generated.h"
 
 namespace MatchState
@@ -26,6 +27,26 @@ namespace MatchState
 }
 
 enum class EWaveState : uint8;
+enum class ECSLiveCounter : uint8;
+
+/** Live pawns with a health component, by what they are counted as */
+struct UE4COOP_API FCSLiveCounters
+{
+    /** Live pawns that are not player controlled */
+    int32 NumBots;
+
+    /** Live player controlled pawns */
+    int32 NumPlayers;
+
+    FCSLiveCounters()
+        : NumBots(0)
+        , NumPlayers(0)
+    {
+    }
+
+    /** Count a pawn as NewCounter instead of Counter and update Counter, returns false when it already was */
+    bool Update(ECSLiveCounter& Counter, ECSLiveCounter NewCounter);
+};
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnActorKilled, AActor*, Victim, AActor*, Killer, AController*, KillerController);
 
@@ -98,11 +119,20 @@ protected:
     */
     virtual void HandleRoundHasEnded();
 
+    /** Round and match end conditions have to be checked again on the next tick */
+    void MarkRoundStateDirty();
+
 private:
 
     /** Current Round Number */
     int32 CurrentRound;
 
+    /** Set when something the round and match end conditions depend on has changed */
+    bool bRoundStateDirty;
+
+    /** Number of live bots and players with a health component */
+    FCSLiveCounters LiveCounters;
+
 protected:
 
     /** Whether the player won this game match  (TODO: COCO remove this in the feature) */
@@ -128,12 +158,26 @@ public:
     UFUNCTION(BlueprintPure, Category = "Game")
     FORCEINLINE int32 GetCurrentRound() const { return CurrentRound; }
 
+    /** Get the number of live bots */
+    UFUNCTION(BlueprintPure, Category = "Game")
+    FORCEINLINE int32 GetNumLiveBots() const { return LiveCounters.NumBots; }
+
+    /** Get the number of live players */
+    UFUNCTION(BlueprintPure, Category = "Game")
+    FORCEINLINE int32 GetNumLivePlayers() const { return LiveCounters.NumPlayers; }
+
+    /** [server] Move a health component counted as Counter to NewCounter, see UCSHealthComponent::UpdateLiveCounter */
+    void UpdateLiveCounter(ECSLiveCounter& Counter, ECSLiveCounter NewCounter);
+
 protected:
 
     /** Flag to indicate if this Game Mode allows friendly fire */
     UPROPERTY(EditDefaultsOnly, Category = "GameMode")
     bool bAllowFriendlyFire;
 
+    /** Attitude between teams, game modes with more than two sides set it up on init */
+    FCSTeamAttitudeMatrix TeamAttitudes;
+
     /** The amount of score a player gains when killing an enemy */
     UPROPERTY(EditDefaultsOnly, Category = "GameMode")
     float ScorePerKill;
@@ -162,6 +206,10 @@ protected:
     UPROPERTY(EditDefaultsOnly, Category = "End")
     float TravelDelay;
 
+    /** Actors spawned into the actor pool during PreRound, so the round itself doesn't hitch on spawns */
+    UPROPERTY(EditDefaultsOnly, Category = "Pooling")
+    TMap<TSubclassOf<AActor>, int32> PrewarmedActors;
+
 protected:
 
     /** Initialize game state default values */
@@ -193,6 +241,14 @@ public:
     UFUNCTION(BlueprintCallable, Category = "GameMode")
     bool IsFriendlyFireAllowed();
 
+    /** Attitude of TeamA towards TeamB */
+    UFUNCTION(BlueprintPure, Category = "GameMode")
+    ECSTeamAttitude GetTeamAttitude(uint8 TeamA, uint8 TeamB) const;
+
+    /** Set the attitude of TeamA towards TeamB, and of TeamB towards TeamA if symmetric */
+    UFUNCTION(BlueprintCallable, Category = "GameMode")
+    void SetTeamAttitude(uint8 TeamA, uint8 TeamB, ECSTeamAttitude Attitude, bool bSymmetric = true);
+
     /** Notify this GameMode about kills */
     virtual void Killed(AController* Killer, AController* KilledPlayer, APawn* KilledPawn, const UDamageType* DamageType);
 
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameState.h"
+#include "CSWeaponStatsSubsystem.h"
 #include "CSGameState.generated.h"
 
 /** Event for match state being changed */
@@ -42,6 +43,9 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Game")
     void SetPlayerWinner(bool bPlayerWon);
 
+    /** [server] Replicate weapon stats rows reloaded on the server, replacing earlier reloads of the same rows */
+    void AddWeaponStatsOverrides(const TArray<FCSWeaponStatsOverride>& Overrides);
+
 public:
 
     //////////////////////////////////////////////////////////////////////////
@@ -79,6 +83,10 @@ protected:
     /** Broadcast matchstate change event */
     virtual void OnRep_MatchState() override;
 
+    /** [client] Load the reloaded weapon stats into our registry */
+    UFUNCTION()
+    void OnRep_WeaponStatsOverrides();
+
 private:
 
     /** Maximum score a team/player can reach */
@@ -101,6 +109,10 @@ private:
     UPROPERTY(Transient, Replicated)
     bool bPlayerWinner;
 
+    /** Weapon stats rows reloaded on the server during this game, also sent to players joining later */
+    UPROPERTY(Transient, ReplicatedUsing = OnRep_WeaponStatsOverrides)
+    TArray<FCSWeaponStatsOverride> WeaponStatsOverrides;
+
 public:
 
     /** Event to be raised when Match State changes */
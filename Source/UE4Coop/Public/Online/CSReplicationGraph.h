@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "CSReplicationGraph.generated.h"
+
+class ACSWeapon;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_GridSpatialization2D;
+
+/** How actors of a class are routed into the replication graph nodes */
+enum class ECSClassRepNodeMapping : uint8
+{
+    /** Not in any global node, replicated per connection or through the actor it depends on */
+    NotRouted,
+    /** Replicated to every connection */
+    RelevantAllConnections,
+    /** Put in the grid once, never moves */
+    Spatialize_Static,
+    /** Moved in the grid every frame */
+    Spatialize_Dynamic,
+    /** Moved in the grid while awake, static while dormant */
+    Spatialize_Dormancy,
+};
+
+/**
+ * [server] Replication graph of the wave co-op game.
+ * Characters, bots and power ups are spatialized in a 2D grid, game and player states are relevant to every
+ * connection and weapons replicate together with the character holding them.
+ */
+UCLASS(Transient, Config = Engine)
+class UE4COOP_API UCSReplicationGraph : public UReplicationGraph
+{
+    GENERATED_BODY()
+
+public:
+
+    UCSReplicationGraph();
+
+    /** Begin UReplicationGraph Interface */
+    virtual void InitGlobalActorClassSettings() override;
+    virtual void InitGlobalGraphNodes() override;
+    virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+    virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+    virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+    /** End UReplicationGraph Interface */
+
+    /** [server] Move a weapon from the dependent actors of the pawn that held it to the ones of the pawn equipping it */
+    static void OnWeaponOwnerChanged(ACSWeapon* Weapon, AActor* OldPawn, AActor* NewPawn);
+
+protected:
+
+    /** Routing of a class, from the explicit game rules or from its replication flags */
+    ECSClassRepNodeMapping GetMappingPolicy(UClass* Class);
+
+    /** Routing from the replication flags of a class default object */
+    static ECSClassRepNodeMapping GetDefaultMappingPolicy(const AActor* ActorCDO);
+
+    /** Size of a grid cell in world units */
+    UPROPERTY(Config)
+    float GridCellSize;
+
+    /** Lowest world location covered by the grid, actors below it are clamped into the first cells */
+    UPROPERTY(Config)
+    FVector2D SpatialBias;
+
+    /** Distance after which bots stop being relevant */
+    UPROPERTY(Config)
+    float BotCullDistance;
+
+    /** Distance after which characters stop being relevant */
+    UPROPERTY(Config)
+    float CharacterCullDistance;
+
+    /** Distance after which power ups and their spawners stop being relevant */
+    UPROPERTY(Config)
+    float PowerUpCullDistance;
+
+    UPROPERTY()
+    UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+    UPROPERTY()
+    UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+private:
+
+    /** Routing of every replicated class */
+    TClassMap<ECSClassRepNodeMapping> ClassRepNodePolicies;
+};
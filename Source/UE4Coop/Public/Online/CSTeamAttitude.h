@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSTeamAttitude.generated.h"
+
+/** How a team treats another team */
+UENUM(BlueprintType)
+enum class ECSTeamAttitude : uint8
+{
+    Allied      UMETA(DisplayName = "Allied"),
+    Neutral     UMETA(DisplayName = "Neutral"),
+    Hostile     UMETA(DisplayName = "Hostile"),
+};
+
+/**
+ * Attitude of every team towards every other team, indexed by health component TeamNum.
+ * Kept as two 256x256 bit tables, a pair set in neither table is neutral.
+ * By default a team is allied with itself and hostile to every other team.
+ */
+struct UE4COOP_API FCSTeamAttitudeMatrix
+{
+public:
+
+    FCSTeamAttitudeMatrix();
+
+    /** Attitude of TeamA towards TeamB */
+    ECSTeamAttitude GetAttitude(uint8 TeamA, uint8 TeamB) const;
+
+    /** Set the attitude of TeamA towards TeamB, and of TeamB towards TeamA if symmetric */
+    void SetAttitude(uint8 TeamA, uint8 TeamB, ECSTeamAttitude Attitude, bool bSymmetric = true);
+
+    /** Go back to every team allied with itself only */
+    void Reset();
+
+private:
+
+    static const int32 NumTeams = 256;
+    static const int32 NumWords = NumTeams * NumTeams / 64;
+
+    /** Set the attitude of a single ordered pair */
+    void SetPairAttitude(uint8 TeamA, uint8 TeamB, ECSTeamAttitude Attitude);
+
+    /** Bit set for allied pairs */
+    uint64 AlliedBits[NumWords];
+
+    /** Bit set for hostile pairs */
+    uint64 HostileBits[NumWords];
+};
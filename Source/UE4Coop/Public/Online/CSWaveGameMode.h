@@ -31,6 +31,10 @@ protected:
     /** Update Number of Bots to Spawn, and call SpawnNewBot */
     void SpawnBotTimerElapse();
 
+    /** Take a bot of BotClass from the actor pool, call from SpawnNewBot instead of spawning it */
+    UFUNCTION(BlueprintCallable, Category = "GameMode")
+    APawn* AcquireBot(const FTransform& SpawnTransform);
+
 private:
 
     /** Initial Number of bots to spawn, set at the beginning of each round */
@@ -39,6 +43,10 @@ private:
     UPROPERTY(EditDefaultsOnly, Category = "GameMode")
     float TimeBetweenWaves;
 
+    /** Bot spawned by AcquireBot, enough of them are pooled during PreRound for the whole wave */
+    UPROPERTY(EditDefaultsOnly, Category = "GameMode")
+    TSubclassOf<APawn> BotClass;
+
     /** Timer Handle for efficient management of BotSpawning */
     FTimerHandle TimerHandle_BotSpawner;
 };
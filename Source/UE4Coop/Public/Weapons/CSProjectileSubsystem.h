@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "CSProjectileSubsystem.generated.h"
+
+class ACSProjectileWeapon;
+class UParticleSystemComponent;
+
+/** A projectile in flight, simulated by the projectile subsystem */
+struct FCSProjectile
+{
+    /** Weapon that launched the projectile, handles its impact */
+    TWeakObjectPtr<ACSProjectileWeapon> Weapon;
+
+    /** [server] Pawn that fired, the damage causer so team checks work as for hitscan shots */
+    TWeakObjectPtr<APawn> InstigatorPawn;
+
+    /** [server] Controller credited with the damage */
+    TWeakObjectPtr<AController> InstigatorController;
+
+    /** Effect following the projectile, nullptr on dedicated servers */
+    TWeakObjectPtr<UParticleSystemComponent> TrailEffect;
+
+    /** Ignores the shooter and its weapon */
+    FCollisionQueryParams QueryParams;
+
+    FVector Location;
+
+    FVector Velocity;
+
+    /** Gravity acceleration along Z */
+    float GravityZ;
+
+    float Radius;
+
+    /** Time left before the projectile explodes on its own */
+    float TimeLeft;
+
+    /** Fraction of the speed kept when bouncing, unused for projectiles exploding on impact */
+    float Bounciness;
+
+    bool bExplodeOnImpact;
+
+    /** Server projectiles do damage, client ones are cosmetic */
+    bool bAuthoritative;
+
+    /** Predicted shot the projectile belongs to, INDEX_NONE when the shooter is not predicting */
+    int32 ShotId;
+
+    FCSProjectile()
+        : GravityZ(0.0f)
+        , Radius(0.0f)
+        , TimeLeft(0.0f)
+        , Bounciness(0.0f)
+        , bExplodeOnImpact(true)
+        , bAuthoritative(false)
+        , ShotId(INDEX_NONE)
+    {
+    }
+};
+
+/**
+ * Simulates every projectile in flight as plain data instead of one actor per shot.
+ * The sweeps of a frame run as one batch, in parallel when there are enough projectiles,
+ * and impacts are handed back to the weapon that launched them.
+ */
+UCLASS()
+class UE4COOP_API UCSProjectileSubsystem : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Begin FTickableGameObject Interface */
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Start simulating a projectile, moved ahead by FastForwardTime right away */
+    void LaunchProjectile(const FCSProjectile& Projectile, float FastForwardTime = 0.0f);
+
+    /** [local] Drop the cosmetic projectile of a predicted shot, returns false when it is no longer in flight */
+    bool RemoveProjectile(const ACSProjectileWeapon* Weapon, int32 ShotId);
+
+    /** Number of projectiles in flight */
+    int32 GetNumProjectiles() const;
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Remove a projectile and let its weapon handle the explosion at its current location */
+    void Explode(int32 Index, const FHitResult* Hit);
+
+    /** Sweep a projectile along its path for DeltaTime, thread safe */
+    static bool SweepProjectile(const UWorld* World, const FCSProjectile& Projectile, float DeltaTime, FVector& OutEndLocation, FHitResult& OutHit);
+
+    /** Move a projectile to the result of its sweep, returns true when it has to explode */
+    static bool ApplySweep(FCSProjectile& Projectile, float DeltaTime, const FVector& EndLocation, const FHitResult& Hit, bool bHit);
+
+private:
+
+    /** Projectiles in flight */
+    TArray<FCSProjectile> Projectiles;
+
+    /** Where each projectile ends up this frame if nothing is in the way */
+    TArray<FVector> EndLocations;
+
+    /** Sweep result of each projectile this frame */
+    TArray<FHitResult> Hits;
+
+    /** Whether the sweep of each projectile hit something */
+    TArray<bool> bDidHit;
+};
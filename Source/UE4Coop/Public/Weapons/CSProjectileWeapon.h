@@ -6,20 +6,115 @@
 #include "CSWeapon.h"
 #include "CSProjectileWeapon.generated.h"
 
+struct FCSProjectile;
+
+/** [local] Where the cosmetic projectile of a predicted shot exploded */
+struct FCSPredictedExplosion
+{
+    int32 ShotId;
+
+    FVector Location;
+};
+
 /**
- * 
+ * Weapon launching projectiles simulated by the projectile subsystem, rockets explode on impact, grenades bounce
+ * until their fuse runs out. The server projectile does the damage, clients simulate their own from the shot events,
+ * where TraceEnd is the launch location plus the launch velocity.
+ *
+ * The owner launches a cosmetic projectile as soon as it fires. The server moves its own projectile ahead by half
+ * the owner's round trip so both fly in step, and tells the owner where every projectile of a predicted shot
+ * exploded. The owner only plays that explosion when its own prediction was further away than
+ * MaxPredictedExplosionError or hadn't exploded yet, see ClientProjectileExploded.
  */
 UCLASS()
 class UE4COOP_API ACSProjectileWeapon : public ACSWeapon
 {
 	GENERATED_BODY()
 
+public:
+
+    ACSProjectileWeapon();
+
 protected:
 
+    /** Launch speed */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon", meta = (ClampMin = 0.0f))
+    float ProjectileSpeed;
+
+    /** Multiplier of the world gravity, 0 flies straight */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon")
+    float ProjectileGravityScale;
+
+    /** Collision radius of the projectile */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon", meta = (ClampMin = 0.0f))
+    float ProjectileRadius;
+
+    /** Time after which the projectile explodes on its own */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon", meta = (ClampMin = 0.0f))
+    float ProjectileLifeSpan;
+
+    /** Explode on the first impact, otherwise bounce until ProjectileLifeSpan runs out */
     UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon")
-    TSubclassOf<AActor> ProjectileClass;
+    bool bExplodeOnImpact;
+
+    /** Fraction of the speed kept when bouncing */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon", meta = (ClampMin = 0.0f, ClampMax = 1.0f, EditCondition = "!bExplodeOnImpact"))
+    float ProjectileBounciness;
+
+    /** Radius of the explosion damage, 0 only damages the actor hit */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon", meta = (ClampMin = 0.0f))
+    float ExplosionRadius;
+
+    /** Effect following the projectile in flight */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon")
+    UParticleSystem* ProjectileEffect;
+
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon")
+    UParticleSystem* ExplosionEffect;
+
+    /** [server] Max time the projectiles of remote owners are moved ahead by to make up for their latency */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon", meta = (ClampMin = 0.0f))
+    float MaxProjectileFastForward;
+
+    /** [local] Distance from the server explosion under which the predicted one is kept */
+    UPROPERTY(EditDefaultsOnly, Category = "ProjectileWeapon", meta = (ClampMin = 0.0f))
+    float MaxPredictedExplosionError;
+
+    /** [local] Last explosions of cosmetic projectiles from predicted shots */
+    TArray<FCSPredictedExplosion> PredictedExplosions;
+
+    /** [server + local] Launch a projectile from the muzzle towards AimRotation */
+    void LaunchProjectile(const FRotator& AimRotation, int32 ShotId, float FastForwardTime);
+
+    /** Add a projectile to the projectile subsystem, with its trail effect */
+    void SimulateProjectile(const FVector& Location, const FVector& Velocity, bool bAuthoritative, int32 ShotId = INDEX_NONE, float FastForwardTime = 0.0f);
+
+    /** [server] Launch the shots of remote owners, they are not traced */
+    virtual bool ProcessShotInput(const FCSShotInput& ShotInput) override;
+
+    /** [server] Time the projectile of a remote owner is moved ahead by, half its round trip */
+    float GetProjectileFastForward() const;
+
+    /** [local] The server projectile of a predicted shot exploded, correct the cosmetic one if it went elsewhere */
+    UFUNCTION(Client, Unreliable)
+    void ClientProjectileExploded(int32 ShotId, FVector_NetQuantize Location);
 
 public:
 
     virtual void Fire() override;
+
+    /** [remote] Shot events are launches, simulate a cosmetic projectile */
+    virtual void PlayFireEffects(const FVector& TraceStart, const FVector& TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType) override;
+
+    /** Play the explosion, and do its damage for server projectiles */
+    void OnProjectileExploded(const FCSProjectile& Projectile, const FVector& Location, const FHitResult* Hit);
 };
+
+namespace CSProjectileExplosions
+{
+    /**
+    * Whether the owner plays the explosion the server reported for a predicted shot. Always when its own projectile
+    * was still in flight, otherwise only when it has no prediction of the shot or predicted it further than MaxError away.
+    */
+    UE4COOP_API bool ShouldPlayServerExplosion(bool bWasInFlight, TArrayView<const FCSPredictedExplosion> PredictedExplosions, int32 ShotId, const FVector& Location, float MaxError);
+}
@@ -4,12 +4,18 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Engine/NetSerialization.h"
+#include "CSPoolableActor.h"
 #include "CSWeapon.generated.h"
 
 class ACSCharacter;
 class USkeletalMeshComponent;
 class UDamageType;
 class UParticleSystem;
+class UCSWeaponStatsSubsystem;
+class UCSHitboxHistoryComponent;
+struct FCSWeaponStats;
+struct FCSWeaponTraceRequest;
 
 UENUM(BlueprintType)
 enum class EWeaponState : uint8
@@ -19,27 +25,278 @@ enum class EWeaponState : uint8
     Reloading
 };
 
+/** Cosmetic result of a single shot, replicated to remote clients to play fire FX */
 USTRUCT()
-struct FHitScanTrace
+struct FCSShotEvent : public FFastArraySerializerItem
 {
     GENERATED_BODY()
 
 public:
 
     UPROPERTY()
-    FHitResult Hit;
+    FVector_NetQuantize TraceStart;
 
+    /** Impact point if the shot hit something, end of the trace otherwise */
     UPROPERTY()
     FVector_NetQuantize TraceEnd;
 
+    UPROPERTY()
+    TEnumAsByte<EPhysicalSurface> SurfaceType;
+
+    UPROPERTY()
+    bool bDidHit;
+
+    /** Seed of the pellet spread for multi-pellet weapons, TraceEnd is then the aim point */
+    UPROPERTY()
+    uint16 PelletSeed;
+
+    FCSShotEvent()
+    {
+        SurfaceType = EPhysicalSurface::SurfaceType_Default;
+        bDidHit = false;
+        PelletSeed = 0;
+    }
+
+    /** [client] Play the FX of a shot that arrived from the server */
+    void PostReplicatedAdd(const struct FCSShotEventArray& InArraySerializer);
+};
+
+/** Every shot fired since the last net update, so none get lost when several are fired in between */
+USTRUCT()
+struct FCSShotEventArray : public FFastArraySerializer
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY()
+    TArray<FCSShotEvent> Items;
+
+    /** Weapon owning this array */
+    UPROPERTY(NotReplicated, Transient)
+    ACSWeapon* Owner;
+
+    /** [server] Add a shot, dropping the oldest ones above the cap */
+    void AddShot(const FVector& TraceStart, const FVector& TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType, uint16 PelletSeed = 0);
+
+    bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+    {
+        return FFastArraySerializer::FastArrayDeltaSerialize<FCSShotEvent, FCSShotEventArray>(Items, DeltaParms, *this);
+    }
+
+    FCSShotEventArray()
+    {
+        Owner = nullptr;
+    }
+};
+
+template<>
+struct TStructOpsTypeTraits<FCSShotEventArray> : public TStructOpsTypeTraitsBase2<FCSShotEventArray>
+{
+    enum
+    {
+        WithNetDeltaSerializer = true,
+    };
+};
+
+/** A single hitscan shot fired locally, waiting for its trace result */
+USTRUCT()
+struct FCSWeaponShot
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY()
+    FVector TraceStart;
+
+    UPROPERTY()
+    FVector TraceEnd;
+
+    UPROPERTY()
+    FVector ShotDirection;
+
+    /** Server time the shooter saw the world at when firing */
+    UPROPERTY()
+    float FireTime;
+
+    /** Predicted action id of the shot, INDEX_NONE when the shooter is not predicting */
+    UPROPERTY()
+    int32 ShotId;
+
+    /** Seed of the pellet spread, the pellets of a shot share it */
+    UPROPERTY()
+    uint16 PelletSeed;
+
+    FCSWeaponShot()
+    {
+        TraceStart = FVector::ZeroVector;
+        TraceEnd = FVector::ZeroVector;
+        ShotDirection = FVector::ForwardVector;
+        FireTime = 0.0f;
+        ShotId = INDEX_NONE;
+        PelletSeed = 0;
+    }
+};
+
+/** Compact description of a shot sent by the firing client, validated by the server */
+USTRUCT()
+struct FCSHitClaim
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY()
+    FVector_NetQuantize TraceStart;
+
+    UPROPERTY()
+    FVector_NetQuantize TraceEnd;
+
+    UPROPERTY()
+    FVector_NetQuantize ImpactPoint;
+
+    /** Actor the client claims to have hit, nullptr if nothing damageable was hit */
+    UPROPERTY()
+    AActor* HitActor;
+
     UPROPERTY()
     bool bDidHit;
 
     UPROPERTY()
     TEnumAsByte<EPhysicalSurface> SurfaceType;
 
+    /** Server time the client saw the world at when firing */
+    UPROPERTY()
+    float ClientFireTime;
+
+    FCSHitClaim()
+    {
+        HitActor = nullptr;
+        bDidHit = false;
+        SurfaceType = EPhysicalSurface::SurfaceType_Default;
+        ClientFireTime = 0.0f;
+    }
+};
+
+/** A shot fired by the owning client, with the ammo it predicted and what it claims to have hit */
+USTRUCT()
+struct FCSShotInput
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY()
+    int32 ShotId;
+
+    UPROPERTY()
+    int32 PredictedAmmoInClip;
+
+    /** Whether the shot traced and Claim is set, projectile shots don't */
+    UPROPERTY()
+    bool bHasClaim;
+
+    UPROPERTY()
+    FCSHitClaim Claim;
+
+    /** Seed of the pellet spread, for multi-pellet weapons */
+    UPROPERTY()
+    uint16 PelletSeed;
+
+    /** One claim per actor hit by the pellets of the shot, Claim then only holds the aim */
     UPROPERTY()
-    uint8 ReplicationCount;
+    TArray<FCSHitClaim> PelletClaims;
+
+    FCSShotInput()
+    {
+        ShotId = INDEX_NONE;
+        PredictedAmmoInClip = 0;
+        bHasClaim = false;
+        PelletSeed = 0;
+    }
+};
+
+/**
+ * Fire input of the owning client for one frame, sent unreliably.
+ * Carries the last shots again so a lost packet doesn't lose them, the server skips the ones it already has.
+ */
+USTRUCT()
+struct FCSFireInput
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Increasing id of the input, older ones arriving late are ignored */
+    UPROPERTY()
+    int32 InputId;
+
+    UPROPERTY()
+    bool bWantsToFire;
+
+    /** View rotation of the shooter when sending, compressed to shorts */
+    UPROPERTY()
+    uint16 ViewPitch;
+
+    UPROPERTY()
+    uint16 ViewYaw;
+
+    /** New and recently sent shots, oldest first */
+    UPROPERTY()
+    TArray<FCSShotInput> Shots;
+
+    FCSFireInput()
+    {
+        InputId = INDEX_NONE;
+        bWantsToFire = false;
+        ViewPitch = 0;
+        ViewYaw = 0;
+    }
+};
+
+/** [server] Ammo of the weapon after the last predicted action of the owner the server processed */
+USTRUCT()
+struct FCSAmmoState
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY()
+    int32 Ammo;
+
+    UPROPERTY()
+    int32 AmmoInClip;
+
+    UPROPERTY()
+    int32 AmmoInMagazine;
+
+    /** Last predicted shot or reload of the owner included in this state */
+    UPROPERTY()
+    int32 LastActionId;
+
+    FCSAmmoState()
+    {
+        Ammo = 0;
+        AmmoInClip = 0;
+        AmmoInMagazine = 0;
+        LastActionId = INDEX_NONE;
+    }
+};
+
+/** [local] Shot or reload the owner predicted, replayed on top of server corrections until acknowledged */
+struct FCSPredictedAmmoAction
+{
+    int32 ActionId;
+
+    bool bReload;
+
+    FCSPredictedAmmoAction(int32 InActionId, bool bInReload)
+        : ActionId(InActionId)
+        , bReload(bInReload)
+    {
+    }
 };
 
 USTRUCT(BlueprintType)
@@ -108,10 +365,37 @@ struct FWeaponAnim
     UAnimSequence* Weapon;
 };
 
+namespace CSWeaponFiring
+{
+    /**
+    * Count the shots owed on a fire rate grid up to Now and move NextFireTime past them.
+    * Shot N is owed at the old NextFireTime + N * TimeBetweenShots. Past MaxShots the rest of a long
+    * hitch is dropped, NextFireTime still stays on the grid. No shot is owed without a fire rate.
+    */
+    UE4COOP_API int32 AdvanceFireGrid(float& NextFireTime, float Now, float TimeBetweenShots, int32 MaxShots);
+}
+
+namespace CSWeaponAmmo
+{
+    /** Fire one round */
+    UE4COOP_API void UseAmmo(FCSAmmoState& Ammo, const FCSWeaponStats& Stats);
+
+    /** Move ammo from the magazine into the clip */
+    UE4COOP_API void ApplyReload(FCSAmmoState& Ammo, const FCSWeaponStats& Stats);
+
+    /**
+    * Owner ammo once a server state arrives: the predicted actions it includes are dropped,
+    * the ones the server didn't process yet are replayed on top of it, oldest first.
+    */
+    UE4COOP_API FCSAmmoState ReconcileAmmo(const FCSAmmoState& ServerAmmo, TArray<FCSPredictedAmmoAction>& PredictedActions, const FCSWeaponStats& Stats);
+}
+
 UCLASS()
-class UE4COOP_API ACSWeapon : public AActor
+class UE4COOP_API ACSWeapon : public AActor, public ICSPoolableActor
 {
 	GENERATED_BODY()
+
+    friend struct FCSShotEventArray;
 	
 public:	
 	// Sets default values for this actor's properties
@@ -120,10 +404,17 @@ public:
 protected:
 
     /** Begin AActor Interface */
-    virtual void BeginPlay() override;
     virtual void PostInitializeComponents() override;
     /** End AActor Interface */
 
+public:
+
+    /** Begin ICSPoolableActor Interface */
+    virtual void OnAcquiredFromPool_Implementation() override;
+    virtual void OnReleasedToPool_Implementation() override;
+    virtual void SetPooled(bool bNewPooled) override;
+    /** End ICSPoolableActor Interface */
+
 public:
 
     //////////////////////////////////////////////////////////////////////////
@@ -147,14 +438,12 @@ protected:
     //////////////////////////////////////////////////////////////////////////
     // Input - server side
 
-    UFUNCTION(Reliable, server, WithValidation)
-    void ServerStartFire();
-
-    UFUNCTION(Reliable, server, WithValidation)
-    void ServerStopFire();
+    /** Fire button, shots and view of a frame, see FCSFireInput */
+    UFUNCTION(Unreliable, server, WithValidation)
+    void ServerFireInput(const FCSFireInput& Input);
 
     UFUNCTION(Reliable, server, WithValidation)
-    void ServerStartReload();
+    void ServerStartReload(int32 ActionId);
 
     UFUNCTION(Reliable, server, WithValidation)
     void ServerStopReload();
@@ -170,6 +459,27 @@ protected:
     /** Consume a bullet */
     void UseAmmo();
 
+    /** Move ammo from the magazine into the clip */
+    void ApplyReload();
+
+    /** Current ammo, LastActionId is left to the caller */
+    FCSAmmoState MakeAmmoState() const;
+
+    /** Take over clip, magazine and total ammo */
+    void ApplyAmmoState(const FCSAmmoState& Ammo);
+
+    /** Whether we are a remote owner predicting our ammo ahead of the server */
+    bool IsPredictingAmmo() const;
+
+    /** [local] Remember a predicted shot or reload until the server acknowledges it */
+    void AddPredictedAmmoAction(int32 ActionId, bool bReload);
+
+    /** [server] Send the current ammo to the owner, acknowledging its predicted actions so far */
+    void ReplicateAmmoState();
+
+    /** [server] Refill clip and magazine with the initial ammo */
+    void ResetAmmo();
+
 protected:
 
     //////////////////////////////////////////////////////////////////////////
@@ -238,6 +548,30 @@ public:
     /** Get current weapon state */
     EWeaponState GetCurrentState() const;
 
+    /** Whether the weapon subsystem should keep advancing the fire of this weapon */
+    bool IsFireScheduled() const;
+
+    /** Stats of this weapon from the weapon stats registry */
+    const FCSWeaponStats& GetStats() const;
+
+    /** Stats set on this weapon Blueprint, used when StatsRowName is not in the weapon stats table */
+    FCSWeaponStats GetBlueprintStats() const;
+
+    /** Row of this weapon in the weapon stats table */
+    FName GetStatsRowName() const;
+
+    //////////////////////////////////////////////////////////////////////////
+    // Fire results
+
+    /** [local + server] Handle the trace result of a shot fired by this weapon */
+    virtual void OnShotTraced(const FCSWeaponShot& Shot, const FHitResult& Hit, bool bDidHit);
+
+    /** [local + server] Handle the traces of all pellets of a shot, the first one flies along the aim */
+    virtual void OnPelletsTraced(TArrayView<const FCSWeaponTraceRequest> Pellets);
+
+    /** [local + server] Fire every shot owed up to Now at the weapon fire rate, at most MaxShots of them */
+    void AdvanceFiring(float Now, int32 MaxShots);
+
 public:
 
     //////////////////////////////////////////////////////////////////////////
@@ -246,6 +580,9 @@ public:
     /** [server] Owner pawn is equipping weapon */
     virtual void OnEquip(ACSCharacter* Character);
 
+    /** [server] Owner pawn dropped the weapon, stops firing and reloading */
+    virtual void OnUnEquip();
+
 protected:
 
     /** [local + server] Firing started */
@@ -254,18 +591,68 @@ protected:
     /** [local + server] Firing finished */
     virtual void OnFireFinished();
 
-    /** [server] Fire & update ammo */
-    UFUNCTION(Reliable, server, WithValidation)
-    void ServerHandleFiring();
+    /** [server] Update ammo for a shot the owner fired and validate its hit claim, returns whether a round was fired */
+    virtual bool ProcessShotInput(const FCSShotInput& ShotInput);
 
-    /** [local + server] Handle weapon fire */
-    void HandleFiring();
+    /** [server] Whether the fire rate allows another shot input of the owner, counting it if it does */
+    bool ConsumeShotInputTime();
+
+    /** [local + server] Handle weapon fire of a shot owed at ShotTime */
+    void HandleFiring(float ShotTime);
 
     /** [server + local] Fire the weapon, do damage and play fire FX */
     virtual void Fire();
 
-    UFUNCTION(Server, Reliable, WithValidation)
-    void ServerFire();
+    /** [server + local] Trace every pellet of a shot as one batch, Shot is along the aim */
+    void FirePellets(FCSWeaponShot& Shot, const FCollisionQueryParams& QueryParams);
+
+    /** Directions of the pellets of a shot, the same for every machine given the same seed */
+    void GetPelletDirections(const FVector& AimDirection, int32 PelletSeed, TArray<FVector>& OutDirections) const;
+
+    /** [server] Validate the shot claimed by the client and apply its damage */
+    void ProcessHitClaim(const FCSHitClaim& Claim);
+
+    /** [server] Validate the pellet claims of a shot and apply one damage per actor hit */
+    void ProcessPelletClaims(const FCSShotInput& ShotInput);
+
+    /** [server] Check a client hit claim against the rewound target, bOutVulnerable is whether the server saw it hit a vulnerable spot */
+    bool ConfirmHitClaim(const FCSHitClaim& Claim, bool& bOutVulnerable) const;
+
+    /** [server] Whether a claimed trace starts and points where the server sees the shooter aim */
+    bool ConfirmClaimAim(const FVector& TraceStart, const FVector& TraceEnd) const;
+
+    /** [server] Time to rewind the target of a claim to, limited by the shooter's latency */
+    float GetClaimRewindTime(const FCSHitClaim& Claim, const UCSHitboxHistoryComponent* HitboxHistory) const;
+
+    /**
+    * [server] Count the pellets of a shot that pass through the target of a confirmed claim
+    *
+    * @param Claim              Confirmed claim of the target
+    * @param TraceStart         Start of every pellet trace
+    * @param PelletEnds         End of each pellet trace, rebuilt from the pellet seed
+    * @param PelletsLeft        Pellets not counted against another target yet, counted pellets are cleared
+    * @param OutNumVulnerable   How many of the counted pellets hit a vulnerable spot
+    */
+    int32 CountPelletHits(const FCSHitClaim& Claim, const FVector& TraceStart, TArrayView<const FVector> PelletEnds, TBitArray<>& PelletsLeft, int32& OutNumVulnerable) const;
+
+    /** [server] Hit result of a confirmed claim */
+    static FHitResult MakeClaimHit(const FCSHitClaim& Claim);
+
+    /** Damage of NumHits bullets or pellets hitting the same actor */
+    float GetHitDamage(int32 NumHits, int32 NumVulnerableHits) const;
+
+    /** [server] Apply damage and statistics for a confirmed hit */
+    void ApplyHitDamage(const FHitResult& Hit, const FVector& ShotDirection, float Damage);
+
+    /** [local] Have the weapon subsystem send our fire input at the end of the frame */
+    void QueueFireInput();
+
+public:
+
+    /** [local] Send the fire input of this frame to the server */
+    void SendFireInput();
+
+protected:
 
     /** Update weapon state */
     void SetWeaponState(EWeaponState NewState);
@@ -273,22 +660,46 @@ protected:
     /** Determine current weapon state */
     void DetermineWeaponState();
 
-    /** [local] Player fire FX */
-    virtual void PlayFireEffects(FHitResult Hit, FVector TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType);
+public:
+
+    /** [local] Player fire FX, TraceEnd is the impact point when the shot hit something */
+    virtual void PlayFireEffects(const FVector& TraceStart, const FVector& TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType);
+
+    /** [remote + server] Fire FX of a multi-pellet shot, traces the pellets again for their impacts */
+    void PlayPelletEffects(const FVector& TraceStart, const FVector& AimEnd, int32 PelletSeed);
+
+protected:
+
+    /** Muzzle flash and camera shake, once per shot */
+    void PlayMuzzleEffects();
+
+    /** Tracer and impact FX of a single bullet or pellet */
+    void PlayImpactEffects(const FVector& TraceStart, const FVector& TraceEnd, bool bDidHit, EPhysicalSurface SurfaceType);
 
 protected:
 
     //////////////////////////////////////////////////////////////////////////
     // Replication
 
-    /** Play Fire FX on remote clients */
-    UFUNCTION()
-    void OnRep_HitScanTrace();
-
     /** Start reload on remote clients too */
     UFUNCTION()
     void OnRep_Reload();
 
+    /** [local] Take the server ammo and replay the predicted actions it doesn't know about yet */
+    UFUNCTION()
+    void OnRep_AmmoState();
+
+    /** [client] Equipped by another pawn, start its inputs and predictions from scratch */
+    UFUNCTION()
+    void OnRep_MyPawn();
+
+    /** Turn collision off while the weapon waits in the actor pool */
+    UFUNCTION()
+    void OnRep_Pooled();
+
+    /** Forget the fire inputs and predicted actions of the previous owner */
+    void ResetShotCounters();
+
 protected:
 
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
@@ -324,19 +735,81 @@ protected:
     UPROPERTY(EditDefaultsOnly, Category = "Weapon")
     float VulnerableDamage;
 
+    /** How far the claimed trace start may be from the server's view of the shooter */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon|HitValidation", meta = (ClampMin = 0.0f))
+    float MaxClaimStartDeviation;
+
+    /** Extra time allowed on top of the shooter ping when rewinding targets */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon|HitValidation", meta = (ClampMin = 0.0f))
+    float ClaimTimeSlack;
+
+    /** How far in degrees a claimed shot may point away from the view sent with it, on top of the spread */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon|HitValidation", meta = (ClampMin = 0.0f))
+    float MaxClaimAngleDeviation;
+
+    /** Number of times a fire input is sent again after it changed, in case the packets get lost */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon|Input", meta = (ClampMin = 0))
+    int32 RedundantFireInputs;
+
+    /** Number of already sent shots carried again by each fire input */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon|Input", meta = (ClampMin = 0))
+    int32 MaxRedundantShots;
+
+    /** [local] Shots fired this frame, not sent yet */
+    TArray<FCSShotInput> PendingShotInputs;
+
+    /** [local] Last shots sent, carried again by the next inputs */
+    TArray<FCSShotInput> RecentShotInputs;
+
+    /** [local] Inputs left to send again after the last change */
+    int32 FireInputResends;
+
+    /** [local] Id of the last input sent, [server] id of the last input received */
+    int32 LastFireInputId;
+
+    /** [server] Last shot of the owner that was processed */
+    int32 LastProcessedShotId;
+
+    /** [server] View rotation received with the last fire input */
+    FRotator LastFireInputView;
+
+    /** [server] World time the fire rate allows the next shot input of the owner at */
+    float NextShotInputTime;
+
+    /** Shot inputs may arrive this much earlier than the fire rate allows, packets bunch them up */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon|Input", meta = (ClampMin = 0.0f))
+    float ShotInputTimeSlack;
+
     /* Bullet Spread In Degrees */
     UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 0.0f))
     float ShootConeAngle;
 
-    float TimeBetweenShots;
+    /** Pellets fired by each shot, more than one makes a shotgun */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 1, ClampMax = 255))
+    int32 PelletCount;
 
+    /** World time of the last shot, on the fire rate grid rather than the frame it was fired in */
     float LastFireTime;
 
-    /** Handle for efficient management of HandleFiring timer */
-    FTimerHandle TimerHandle_HandleFiring;
+    /** World time the next shot is owed at */
+    float NextFireTime;
+
+    /** World time of the shot being fired right now */
+    float CurrentShotTime;
 
-    UPROPERTY(ReplicatedUsing=OnRep_HitScanTrace)
-    FHitScanTrace HitScanTrace;
+    /** Predicted action id of the shot being fired right now */
+    int32 CurrentShotId;
+
+    /** Is the weapon subsystem advancing our fire? */
+    bool bFireScheduled;
+
+    /** Shots fired since the last net update, played as fire FX on remote clients */
+    UPROPERTY(Replicated)
+    FCSShotEventArray ShotEvents;
+
+    /** Max number of shot events kept for replication */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 1))
+    int32 MaxShotEvents;
 
     /** Is weapon fire active? */
     bool bWantsToFire;
@@ -355,22 +828,38 @@ protected:
     UPROPERTY(Transient, ReplicatedUsing = OnRep_Reload)
     bool bPendingReload;
 
-    /** Is weapon currently reloading?*/
-    UPROPERTY(Transient, Replicated)
+    /** Is weapon currently reloading? Predicted by the owner */
     bool bReloading;
 
     /** Current ammo inside magazine*/
-    UPROPERTY(Transient, Replicated)
     int32 CurrentAmmoInMagazine;
 
     /** Current total ammo */
-    UPROPERTY(Transient, Replicated)
     int32 CurrentAmmo;
 
     /** Current ammo - inside clip */
-    UPROPERTY(Transient, Replicated)
     int32 CurrentAmmoInClip;
 
+    /** Server ammo for the owner, only sent on reloads and mispredictions instead of every shot */
+    UPROPERTY(Transient, ReplicatedUsing = OnRep_AmmoState)
+    FCSAmmoState AmmoState;
+
+    /** [local] Id of the next predicted shot or reload */
+    int32 NextAmmoActionId;
+
+    /** [local + server] Id of the reload in progress, INDEX_NONE if it was not predicted */
+    int32 ReloadActionId;
+
+    /** [server] Last predicted action of the owner that was processed */
+    int32 LastAckedAmmoActionId;
+
+    /** [local] Predicted actions not acknowledged by the server yet, oldest first */
+    TArray<FCSPredictedAmmoAction> PredictedAmmoActions;
+
+    /** Max predicted actions kept, older ones are forgotten */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 1))
+    int32 MaxPredictedAmmoActions;
+
     /** Handle for efficient management of StopReload timer */
     FTimerHandle TimerHandle_StopReload;
 
@@ -379,11 +868,26 @@ protected:
 
 protected:
 
-    /** Weapon data */
+    /** Weapon data, used when StatsRowName is not in the weapon stats table */
     UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
     FWeaponData WeaponConfig;
 
+    /** Row of this weapon in the weapon stats table, overrides the stats set on the Blueprint */
+    UPROPERTY(EditDefaultsOnly, Category = "Weapon")
+    FName StatsRowName;
+
+    /** Index of this weapon stats in the registry */
+    int32 StatsIndex;
+
+    /** Registry holding the stats of this weapon */
+    UPROPERTY(Transient)
+    UCSWeaponStatsSubsystem* StatsRegistry;
+
     /** Pawn owning this weapon */
-    UPROPERTY(Transient, Replicated)
+    UPROPERTY(Transient, ReplicatedUsing = OnRep_MyPawn)
     ACSCharacter* MyPawn;
+
+    /** Whether the weapon is stored in the actor pool */
+    UPROPERTY(Transient, ReplicatedUsing = OnRep_Pooled)
+    bool bPooled;
 };
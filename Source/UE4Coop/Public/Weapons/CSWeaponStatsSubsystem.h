@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Engine/DataTable.h"
+#include "CSWeaponStatsSubsystem.generated.h"
+
+class ACSWeapon;
+class UWorld;
+
+/** Balancing stats of a weapon, one row per weapon in the weapon stats table */
+USTRUCT(BlueprintType)
+struct FCSWeaponStatsRow : public FTableRowBase
+{
+    GENERATED_BODY()
+
+    /** Infinite ammo for reloads */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ammo")
+    bool bInfiniteAmmo;
+
+    /** Infinite ammo in clip, no reload required */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ammo")
+    bool bInfiniteClip;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ammo")
+    int32 MaxAmmo;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ammo")
+    int32 AmmoPerClip;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ammo")
+    int32 InitialClips;
+
+    /** Failsafe reload duration if weapon doesn't have any animation for it */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "WeaponStats")
+    float NoAnimReloadDuration;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "WeaponStats")
+    float WeaponRange;
+
+    /** Shots per minute */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "WeaponStats")
+    float RateOfFire;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "WeaponStats")
+    float BaseDamage;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "WeaponStats")
+    float VulnerableDamage;
+
+    /** Bullet spread in degrees */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "WeaponStats")
+    float ShootConeAngle;
+
+    /** Pellets fired by each shot, spread over the cone and traced together */
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "WeaponStats", meta = (ClampMin = 1, ClampMax = 255))
+    int32 PelletCount;
+
+    FCSWeaponStatsRow()
+    {
+        bInfiniteAmmo = false;
+        bInfiniteClip = false;
+        MaxAmmo = 100;
+        AmmoPerClip = 20;
+        InitialClips = 5;
+        NoAnimReloadDuration = 1.0f;
+        WeaponRange = 10000.0f;
+        RateOfFire = 700.0f;
+        BaseDamage = 20.0f;
+        VulnerableDamage = 50.0f;
+        ShootConeAngle = 2.0f;
+        PelletCount = 1;
+    }
+};
+
+/** Table row reloaded on the server, replicated so clients fire with the same stats */
+USTRUCT()
+struct FCSWeaponStatsOverride
+{
+    GENERATED_BODY()
+
+    UPROPERTY()
+    FName RowName;
+
+    UPROPERTY()
+    FCSWeaponStatsRow Row;
+};
+
+/** Packed stats a weapon reads while firing, built once from a table row or the weapon Blueprint */
+struct FCSWeaponStats
+{
+    float BaseDamage;
+    float VulnerableDamage;
+    float ShootConeAngle;
+    float WeaponRange;
+
+    /** Seconds between two shots, from the rate of fire */
+    float TimeBetweenShots;
+
+    float NoAnimReloadDuration;
+
+    int32 MaxAmmo;
+    int32 AmmoPerClip;
+    int32 InitialClips;
+    int32 PelletCount;
+
+    bool bInfiniteAmmo;
+    bool bInfiniteClip;
+
+    FCSWeaponStats();
+
+    explicit FCSWeaponStats(const FCSWeaponStatsRow& Row);
+};
+
+/**
+ * Registry of the stats of every weapon, loaded once per game instance.
+ * Weapons with a row in the configured table use it, others register the stats set on their Blueprint.
+ * Weapons keep an index into the registry so spawning one copies nothing.
+ */
+UCLASS(Config = Game)
+class UE4COOP_API UCSWeaponStatsSubsystem : public UGameInstanceSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Begin USubsystem Interface */
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    /** End USubsystem Interface */
+
+    /** Index of the stats of a weapon, registering its Blueprint stats if it has no table row */
+    int32 FindOrAddWeaponStats(const ACSWeapon* Weapon);
+
+    /** Stats at an index returned by FindOrAddWeaponStats, don't keep the reference across a reload */
+    const FCSWeaponStats& GetStats(int32 StatsIndex) const;
+
+    /** Stats used when a weapon has no registry */
+    static const FCSWeaponStats& GetDefaultStats();
+
+    /**
+     * [server] Reload table rows from a CSV file on disk, indices of existing rows are kept.
+     * The rows are handed to the game state of World, which replicates them to clients.
+     */
+    bool ReloadFromCSV(const FString& FilePath, UWorld* World);
+
+    /** [client] Apply rows reloaded on the server */
+    void LoadOverrides(const TArray<FCSWeaponStatsOverride>& Overrides);
+
+protected:
+
+    /** Add or update the stats of every row of a table */
+    void LoadTable(const UDataTable* Table);
+
+    /** Add or update the stats of a row */
+    void LoadRow(FName RowName, const FCSWeaponStatsRow& Row);
+
+    /** Weapon stats table, rows are looked up by ACSWeapon::StatsRowName */
+    UPROPERTY(Config)
+    FSoftObjectPath WeaponStatsTable;
+
+private:
+
+    /** Stats of every known weapon */
+    TArray<FCSWeaponStats> Stats;
+
+    /** Index of each table row */
+    TMap<FName, int32> RowIndices;
+
+    /** Index of each weapon class without a table row */
+    TMap<TWeakObjectPtr<UClass>, int32> ClassIndices;
+};
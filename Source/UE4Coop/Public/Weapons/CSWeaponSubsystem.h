@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CSWorldSubsystem.h"
+#include "CSWeapon.h"
+#include "CSWeaponSubsystem.generated.h"
+
+/** A hitscan trace queued by a weapon, resolved with the rest of the frame's shots */
+struct FCSWeaponTraceRequest
+{
+    /** Weapon the result is delivered back to */
+    TWeakObjectPtr<ACSWeapon> Weapon;
+
+    /** Shot the trace belongs to */
+    FCSWeaponShot Shot;
+
+    FCollisionQueryParams QueryParams;
+
+    FHitResult Hit;
+
+    bool bDidHit;
+
+    /** Pellet traces of the same shot starting at this one, delivered together. 0 for the other pellets */
+    int32 NumPellets;
+
+    FCSWeaponTraceRequest()
+        : bDidHit(false)
+        , NumPellets(1)
+    {
+    }
+};
+
+/**
+ * Collects the hitscan traces of every weapon firing during a frame and runs them as one batch
+ * at the end of the frame, in parallel when there are enough of them.
+ * Also drives the fire rate of firing weapons, so every shot owed in a frame gets fired.
+ */
+UCLASS()
+class UE4COOP_API UCSWeaponSubsystem : public UCSWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Begin FTickableGameObject Interface */
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+    /** End FTickableGameObject Interface */
+
+    /** Whether weapons should queue their traces instead of running them right away */
+    static bool IsTraceBatchingEnabled();
+
+    /** Queue a hitscan trace, the weapon gets the result through OnShotTraced before the frame ends */
+    void QueueTrace(ACSWeapon* Weapon, const FCSWeaponShot& Shot, const FCollisionQueryParams& QueryParams);
+
+    /** Queue the traces of every pellet of a shot, the weapon gets them all at once through OnPelletsTraced */
+    void QueuePelletTraces(ACSWeapon* Weapon, TArrayView<const FCSWeaponShot> Pellets, const FCollisionQueryParams& QueryParams);
+
+    /** Advance the weapon fire every frame until it stops firing */
+    void StartFiring(ACSWeapon* Weapon);
+
+    /** [local] Send the fire input of the weapon once the frame's shots are traced */
+    void QueueFireInput(ACSWeapon* Weapon);
+
+    /** Most shots a single weapon may fire in one frame, the rest of a long hitch is dropped */
+    static int32 GetMaxShotsPerFrame();
+
+protected:
+
+    /** Begin UCSWorldSubsystem Interface */
+    virtual void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources) override;
+    /** End UCSWorldSubsystem Interface */
+
+    /** Fire the shots every firing weapon owes up to the current time */
+    void AdvanceFiring();
+
+    /** Run all queued traces and deliver the results to their weapons */
+    void FlushTraces();
+
+    /** Send the fire input of every weapon that queued one */
+    void SendFireInputs();
+
+private:
+
+    /** Traces queued this frame */
+    TArray<FCSWeaponTraceRequest> PendingTraces;
+
+    /** Weapons currently firing */
+    TArray<TWeakObjectPtr<ACSWeapon>> FiringWeapons;
+
+    /** Weapons with a fire input to send this frame */
+    TArray<TWeakObjectPtr<ACSWeapon>> InputWeapons;
+};
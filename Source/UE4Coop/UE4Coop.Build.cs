@@ -8,7 +8,7 @@ public class UE4Coop : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "NavigationSystem", "GameplayAbilities", "GameplayTags", "GameplayTasks" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "NavigationSystem", "GameplayAbilities", "GameplayTags", "GameplayTasks", "ReplicationGraph" });
 
 		PrivateDependencyModuleNames.AddRange(new string[] { });
 